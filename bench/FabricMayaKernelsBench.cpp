@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+// Measures the buffer kernels of the Maya <-> KL conversions on
+// synthetic data, without Maya or Fabric. Build with 'scons bench'.
+// Usage: FabricMayaKernelsBench [maxElements]
+
+#include "FabricMayaKernels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+using namespace FabricMaya;
+
+static double getSeconds()
+{
+#if defined(_WIN32)
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec * 1.0e-6;
+#endif
+}
+
+// repeats the kernel until at least 0.2 seconds have passed
+// and prints the throughput of a single run
+struct Measure
+{
+  const char * name;
+  size_t count;
+  size_t bytes;
+  int runs;
+  double start;
+
+  Measure(const char * name_, size_t count_, size_t bytes_)
+  : name(name_), count(count_), bytes(bytes_), runs(0)
+  {
+    start = getSeconds();
+  }
+
+  bool next()
+  {
+    double elapsed = getSeconds() - start;
+    if(runs > 0 && elapsed >= 0.2)
+    {
+      double seconds = elapsed / (double)runs;
+      printf("%-20s %10lu %12.2f Melem/s %10.1f MB/s\n",
+        name,
+        (unsigned long)count,
+        (double)count / seconds * 1.0e-6,
+        (double)bytes / seconds / (1024.0 * 1024.0));
+      return false;
+    }
+    runs++;
+    return true;
+  }
+};
+
+// keeps the compiler from dropping the results
+static volatile double s_sink = 0.0;
+
+static void benchMatrices(size_t count)
+{
+  std::vector<double> src(count * 16);
+  for(size_t i=0;i<src.size();i++)
+    src[i] = (double)(i % 17);
+  std::vector<float> dst(count * 16);
+
+  Measure m("MatricesToMat44", count, count * 16 * (sizeof(double) + sizeof(float)));
+  while(m.next())
+    Kernels::MatricesToMat44(&src[0], &dst[0], count);
+  s_sink += dst[count * 16 - 1];
+}
+
+static void benchGathers(size_t count)
+{
+  // a quad grid, every vertex is shared by four samples
+  size_t numVertices = count / 4 + 1;
+  std::vector<int> indices(count);
+  for(size_t i=0;i<count;i++)
+    indices[i] = (int)((i * 7919) % numVertices);
+
+  std::vector<float> src(numVertices * 3, 1.0f);
+  std::vector<float> dst(count * 3);
+  {
+    Measure m("GatherVec3", count, count * (sizeof(int) + 6 * sizeof(float)));
+    while(m.next())
+      Kernels::GatherVec3(&src[0], &indices[0], count, &dst[0]);
+    s_sink += dst[count * 3 - 1];
+  }
+
+  std::vector<float> u(numVertices, 0.5f), v(numVertices, 0.25f);
+  std::vector<float> uvs(count * 2);
+  {
+    Measure m("GatherUVs", count, count * (sizeof(int) + 4 * sizeof(float)));
+    while(m.next())
+      Kernels::GatherUVs(&u[0], &v[0], &indices[0], count, &uvs[0]);
+    s_sink += uvs[count * 2 - 1];
+  }
+}
+
+static void benchFaceVertexIds(size_t count)
+{
+  size_t numFaces = count / 4;
+  if(numFaces == 0)
+    return;
+  size_t numSamples = numFaces * 4;
+  std::vector<int> counts(numFaces, 4);
+  std::vector<int> indices(numSamples);
+  for(size_t i=0;i<numSamples;i++)
+    indices[i] = (int)i;
+  std::vector<int> faceIds(numSamples), vertexIds(numSamples);
+
+  Measure m("BuildFaceVertexIds", numSamples, numSamples * 3 * sizeof(int));
+  while(m.next())
+    Kernels::BuildFaceVertexIds(&counts[0], numFaces, &indices[0], numSamples, &faceIds[0], &vertexIds[0]);
+  s_sink += faceIds[numSamples - 1];
+}
+
+static void benchPolylines(size_t count)
+{
+  std::vector<double> src(count * 4, 1.0);
+  std::vector<double> dst(count * 3);
+  {
+    Measure m("PackPoints", count, count * 7 * sizeof(double));
+    while(m.next())
+      Kernels::PackPoints(&src[0], count, &dst[0]);
+    s_sink += dst[count * 3 - 1];
+  }
+
+  std::vector<uint32_t> segments(Kernels::PolylineSegmentCount(count, true) * 2);
+  {
+    Measure m("BuildPolyline", count, segments.size() * sizeof(uint32_t));
+    while(m.next())
+      Kernels::BuildPolylineSegments(count, true, &segments[0]);
+    s_sink += segments[segments.size() - 1];
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  size_t maxCount = 10000000;
+  if(argc > 1)
+    maxCount = (size_t)strtoul(argv[1], NULL, 10);
+
+  printf("%-20s %10s %20s %15s\n", "kernel", "elements", "throughput", "bandwidth");
+  for(size_t count=1000;count<=maxCount;count*=10)
+  {
+    // 10M matrices would need 1.8GB
+    if(count <= 1000000)
+      benchMatrices(count);
+    benchGathers(count);
+    benchFaceVertexIds(count);
+    benchPolylines(count);
+  }
+  return 0;
+}
@@ -0,0 +1,152 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+// Measures the KL syntax highlighter on generated KL source, with Qt
+// only. Build with 'scons bench', it is built when MAYA_INCLUDE_DIR
+// and MAYA_LIB_DIR point to the Qt which ships with Maya.
+// Usage: FabricSpliceKLSyntaxHighlighterBench [maxLines]
+
+#include "FabricSpliceKLSyntaxHighlighter.h"
+
+#include <QtGui/QApplication>
+#include <QtGui/QTextBlock>
+#include <QtGui/QTextCursor>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+static double getSeconds()
+{
+#if defined(_WIN32)
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec * 1.0e-6;
+#endif
+}
+
+// repeats the run until at least 0.2 seconds have passed
+// and prints the cost of a single run
+struct Measure
+{
+  const char * name;
+  size_t lines;
+  int runs;
+  double start;
+
+  Measure(const char * name_, size_t lines_)
+  : name(name_), lines(lines_), runs(0)
+  {
+    start = getSeconds();
+  }
+
+  bool next()
+  {
+    double elapsed = getSeconds() - start;
+    if(runs > 0 && elapsed >= 0.2)
+    {
+      double seconds = elapsed / (double)runs;
+      printf("%-20s %10lu %12.3f ms %12.2f Klines/s\n",
+        name,
+        (unsigned long)lines,
+        seconds * 1000.0,
+        (double)lines / seconds * 1.0e-3);
+      return false;
+    }
+    runs++;
+    return true;
+  }
+};
+
+// an operator with keywords, types, strings and both kinds of comments
+static QString generateSource(size_t lines)
+{
+  static const char * snippet[] = {
+    "/*",
+    "  multi line comment describing the operator",
+    "*/",
+    "require Math;",
+    "operator deformPoints<<<index>>>(io Vec3 positions[], Mat44 matrix, Scalar weight) {",
+    "  Vec3 p = positions[index]; // the input position",
+    "  if(weight > 0.0 && index < positions.size()) {",
+    "    positions[index] = p + (matrix * p - p) * weight;",
+    "  } else {",
+    "    report(\"skipped point \" + index + \" with weight \" + weight);",
+    "  }",
+    "}",
+    NULL
+  };
+
+  QStringList result;
+  for(size_t i=0;i<lines;)
+  {
+    for(int j=0;snippet[j] && i<lines;j++, i++)
+      result << QString::fromLatin1(snippet[j]);
+  }
+  return result.join(QString::fromLatin1("\n"));
+}
+
+static void benchHighlighter(size_t lines)
+{
+  QString source = generateSource(lines);
+  QTextDocument document;
+  document.setPlainText(source);
+  FabricSpliceKLSyntaxHighlighter highlighter(&document);
+
+  {
+    Measure m("rehighlight", lines);
+    while(m.next())
+      highlighter.rehighlight();
+  }
+
+  // typing into the middle of the source only
+  // highlights the edited block again
+  {
+    QTextCursor cursor(document.findBlockByNumber((int)(lines / 2)));
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    Measure m("type", 1);
+    while(m.next())
+    {
+      cursor.insertText(QString::fromLatin1("x"));
+      cursor.deletePreviousChar();
+    }
+  }
+
+  // opening a comment highlights all of the following blocks
+  {
+    QTextCursor cursor(document.findBlockByNumber((int)(lines / 2)));
+    Measure m("open comment", lines - lines / 2);
+    while(m.next())
+    {
+      cursor.insertText(QString::fromLatin1("/*"));
+      cursor.deletePreviousChar();
+      cursor.deletePreviousChar();
+    }
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  // the text formats need the font database of a GUI application
+  QApplication app(argc, argv);
+
+  size_t maxLines = 100000;
+  if(argc > 1)
+    maxLines = (size_t)strtoul(argv[1], NULL, 10);
+
+  printf("%-20s %10s %15s %20s\n", "case", "lines", "time", "throughput");
+  for(size_t lines=100;lines<=maxLines;lines*=10)
+    benchHighlighter(lines);
+  return 0;
+}
@@ -16,6 +16,9 @@
 
 #include <sstream>
 
+std::map<unsigned int, FabricCore::RTVal> DFGUICmdHandler_Maya::s_valueSnapshots;
+unsigned int DFGUICmdHandler_Maya::s_nextValueSnapshot = 1;
+
 void DFGUICmdHandler_Maya::encodeBooleanArg(
   FTL::CStrRef name,
   bool value,
@@ -892,6 +895,9 @@ void DFGUICmdHandler_Maya::dfgDoSetArgValue(
   encodeBinding( binding, cmd );
   encodeStringArg( FTL_STR("n"), name, cmd );
   encodeStringArg( FTL_STR("t"), value.getTypeNameCStr(), cmd );
+  unsigned int handle = storeValueSnapshot(
+    binding.getHost().getContext(), value );
+  cmd << " -vh " << handle;
   FabricCore::RTVal valueJSON = value.getJSON();
   encodeStringArg( FTL_STR("v"), valueJSON.getStringCString(), cmd );
   cmd << ';';
@@ -901,6 +907,10 @@ void DFGUICmdHandler_Maya::dfgDoSetArgValue(
     true, // displayEnabled
     true  // undoEnabled
     );
+
+  // drop the snapshot if the command failed before consuming it
+  FabricCore::RTVal unused;
+  takeValueSnapshot( handle, unused );
 }
 
 void DFGUICmdHandler_Maya::dfgDoSetPortDefaultValue(
@@ -916,8 +926,9 @@ void DFGUICmdHandler_Maya::dfgDoSetPortDefaultValue(
   encodeExec( binding, execPath, exec, cmd );
   encodeStringArg( FTL_STR("p"), portPath, cmd );
   encodeStringArg( FTL_STR("t"), value.getTypeNameCStr(), cmd );
-
   FabricCore::Context context = binding.getHost().getContext();
+  unsigned int handle = storeValueSnapshot( context, value );
+  cmd << " -vh " << handle;
   std::string json = encodeRTValToJSON(context, value);
   encodeStringArg( FTL_STR("v"), json.c_str(), cmd );
   cmd << ';';
@@ -927,6 +938,10 @@ void DFGUICmdHandler_Maya::dfgDoSetPortDefaultValue(
     true, // displayEnabled
     true  // undoEnabled
     );
+
+  // drop the snapshot if the command failed before consuming it
+  FabricCore::RTVal unused;
+  takeValueSnapshot( handle, unused );
 }
 
 void DFGUICmdHandler_Maya::dfgDoSetRefVarPath(
@@ -1069,3 +1084,39 @@ MString DFGUICmdHandler_Maya::getNodeNameFromBinding(
   MFnDependencyNode thisNode(interf->getThisMObject());
   return thisNode.name();
 }
+
+unsigned int DFGUICmdHandler_Maya::storeValueSnapshot(
+  FabricCore::Context const &context,
+  FabricCore::RTVal const &value
+  )
+{
+  // take a copy so that later edits of the caller's value
+  // don't leak into the command
+  FabricCore::RTVal snapshot;
+  if ( value.isValid() && !value.isObject() )
+  {
+    FabricCore::RTVal arg = value;
+    snapshot = FabricCore::RTVal::Construct(
+      context, value.getTypeNameCStr(), 1, &arg );
+  }
+  else
+    snapshot = value;
+
+  unsigned int handle = s_nextValueSnapshot++;
+  s_valueSnapshots.insert( std::make_pair( handle, snapshot ) );
+  return handle;
+}
+
+bool DFGUICmdHandler_Maya::takeValueSnapshot(
+  unsigned int handle,
+  FabricCore::RTVal &value
+  )
+{
+  std::map<unsigned int, FabricCore::RTVal>::iterator it =
+    s_valueSnapshots.find( handle );
+  if ( it == s_valueSnapshots.end() )
+    return false;
+  value = it->second;
+  s_valueSnapshots.erase( it );
+  return true;
+}
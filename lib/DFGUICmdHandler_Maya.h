@@ -7,6 +7,8 @@
 #include <FabricUI/DFG/DFGUICmdHandler.h>
 #include <maya/MString.h>
 
+#include <map>
+
 class FabricDFGBaseInterface;
 
 class DFGUICmdHandler_Maya : public FabricUI::DFG::DFGUICmdHandler
@@ -15,6 +17,16 @@ public:
 
   DFGUICmdHandler_Maya() {}
 
+  // values passed to the SetArgValue / SetPortDefaultValue commands
+  // travel out-of-band through this table, the MEL command only carries
+  // the handle (-vh), which spares decoding the JSON. the JSON (-v) is
+  // always added so that the journaled command can still be replayed.
+  static unsigned int storeValueSnapshot(
+    FabricCore::Context const &context,
+    FabricCore::RTVal const &value
+    );
+  static bool takeValueSnapshot( unsigned int handle, FabricCore::RTVal &value );
+
 protected:
 
   virtual void dfgDoRemoveNodes(
@@ -354,4 +366,7 @@ protected:
 
   static FabricDFGBaseInterface * getInterfFromBinding( FabricCore::DFGBinding const &binding );
   static MString getNodeNameFromBinding( FabricCore::DFGBinding const &binding );
+
+  static std::map<unsigned int, FabricCore::RTVal> s_valueSnapshots;
+  static unsigned int s_nextValueSnapshot;
 };
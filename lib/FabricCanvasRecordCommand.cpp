@@ -0,0 +1,63 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#include "FabricCanvasRecordCommand.h"
+#include "FabricDFGRecorder.h"
+#include "FabricSpliceHelpers.h"
+
+#include <maya/MSyntax.h>
+#include <maya/MArgParser.h>
+
+#define kFileFlag "-f"
+#define kFileFlagLong "-file"
+#define kStopFlag "-s"
+#define kStopFlagLong "-stop"
+#define kPlaybackOnlyFlag "-p"
+#define kPlaybackOnlyFlagLong "-playbackOnly"
+
+MSyntax FabricCanvasRecordCommand::newSyntax()
+{
+  MSyntax syntax;
+  syntax.addFlag(kFileFlag, kFileFlagLong, MSyntax::kString);
+  syntax.addFlag(kStopFlag, kStopFlagLong, MSyntax::kNoArg);
+  syntax.addFlag(kPlaybackOnlyFlag, kPlaybackOnlyFlagLong, MSyntax::kNoArg);
+  syntax.enableQuery(false);
+  syntax.enableEdit(false);
+  return syntax;
+}
+
+void* FabricCanvasRecordCommand::creator()
+{
+  return new FabricCanvasRecordCommand;
+}
+
+MStatus FabricCanvasRecordCommand::doIt(const MArgList &args)
+{
+  MStatus status;
+  MArgParser argData(syntax(), args, &status);
+  if(status != MS::kSuccess)
+    return status;
+
+  if(argData.isFlagSet("stop"))
+  {
+    FabricDFGRecorder::stop();
+    setResult((int)FabricDFGRecorder::getNumEvaluations());
+    return MS::kSuccess;
+  }
+
+  if(argData.isFlagSet("file"))
+  {
+    MString filePath = argData.flagArgumentString("file", 0);
+    if(filePath.length() == 0)
+    {
+      mayaLogErrorFunc(MString(getName()) + ": -file requires a file path.");
+      return mayaErrorOccured();
+    }
+    if(!FabricDFGRecorder::start(filePath, argData.isFlagSet("playbackOnly")))
+      return mayaErrorOccured();
+  }
+
+  setResult(FabricDFGRecorder::getFilePath());
+  return MS::kSuccess;
+}
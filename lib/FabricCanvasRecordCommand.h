@@ -0,0 +1,19 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#pragma once
+
+#include <maya/MPxCommand.h>
+#include <maya/MArgList.h>
+
+// starts (-file), stops (-stop) or queries the recording of the
+// Canvas node evaluations, see FabricDFGRecorder. Returns the file
+// being recorded to, or the number of recorded evaluations on -stop.
+class FabricCanvasRecordCommand: public MPxCommand{
+public:
+  static void* creator();
+  static MSyntax newSyntax();
+
+  MStatus doIt(const MArgList &args);
+};
@@ -0,0 +1,390 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#include "FabricCanvasStatsCommand.h"
+
+#include <maya/MStringArray.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MPlug.h>
+#include <maya/MGlobal.h>
+#include <maya/MSyntax.h>
+#include <maya/MArgParser.h>
+
+#include "FabricSpliceBaseInterface.h"
+#include "FabricDFGBaseInterface.h"
+
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <algorithm>
+
+#define kNodesFlag "-n"
+#define kNodesFlagLong "-nodes"
+#define kTopFlag "-t"
+#define kTopFlagLong "-top"
+
+namespace
+{
+  struct NodeStats
+  {
+    std::string name;
+    std::string kind;
+    bool compiled;
+    bool released;
+    unsigned int numIn;
+    unsigned int numOut;
+    unsigned int numIO;
+    std::map<std::string, unsigned int> portTypes;
+    unsigned int saveDataSize;
+    unsigned int arrayElements;
+    unsigned int meshCount;
+    unsigned int meshPoints;
+    unsigned int meshPolygons;
+    double estimatedBytes;
+    unsigned int evalCount;
+    double lastExecuteSeconds;
+    double totalExecuteSeconds;
+
+    NodeStats()
+      : compiled(false)
+      , released(false)
+      , numIn(0)
+      , numOut(0)
+      , numIO(0)
+      , saveDataSize(0)
+      , arrayElements(0)
+      , meshCount(0)
+      , meshPoints(0)
+      , meshPolygons(0)
+      , estimatedBytes(0.0)
+      , evalCount(0)
+      , lastExecuteSeconds(0.0)
+      , totalExecuteSeconds(0.0)
+    {}
+  };
+
+  void addValueStats(NodeStats & stats, const std::string & type, FabricCore::RTVal value)
+  {
+    if(!value.isValid())
+      return;
+
+    stats.estimatedBytes += FabricDFGBaseInterface::estimateValueMemory(type, value);
+
+    bool isMesh = type.substr(0, 11) == "PolygonMesh";
+    if(value.isArray())
+    {
+      unsigned int size = value.getArraySize();
+      stats.arrayElements += size;
+      if(!isMesh)
+        return;
+      for(unsigned int i=0;i<size;i++)
+      {
+        FabricCore::RTVal mesh = value.getArrayElement(i);
+        if(mesh.isNullObject())
+          continue;
+        stats.meshCount++;
+        stats.meshPoints += mesh.callMethod("UInt32", "pointCount", 0, 0).getUInt32();
+        stats.meshPolygons += mesh.callMethod("UInt32", "polygonCount", 0, 0).getUInt32();
+      }
+    }
+    else if(isMesh && !value.isNullObject())
+    {
+      stats.meshCount++;
+      stats.meshPoints += value.callMethod("UInt32", "pointCount", 0, 0).getUInt32();
+      stats.meshPolygons += value.callMethod("UInt32", "polygonCount", 0, 0).getUInt32();
+    }
+  }
+
+  void collectCanvasStats(FabricDFGBaseInterface * interf, NodeStats & stats)
+  {
+    stats.kind = "canvas";
+    stats.released = interf->areArgValuesReleased();
+    stats.evalCount = interf->getEvalCount();
+    stats.lastExecuteSeconds = interf->getLastExecuteSeconds();
+    stats.totalExecuteSeconds = interf->getTotalExecuteSeconds();
+
+    MPlug saveDataPlug = interf->getSaveDataPlug();
+    if(!saveDataPlug.isNull())
+      stats.saveDataSize = saveDataPlug.asString().length();
+
+    FabricCore::DFGBinding binding = interf->getDFGBinding();
+    if(!binding.isValid())
+      return;
+
+    FabricCore::DFGExec exec = binding.getExec();
+    stats.compiled = exec.getErrorCount() == 0;
+
+    for(unsigned int i=0;i<exec.getExecPortCount();i++)
+    {
+      FabricCore::DFGPortType portType = exec.getExecPortType(i);
+      if(portType == FabricCore::DFGPortType_In)
+        stats.numIn++;
+      else if(portType == FabricCore::DFGPortType_Out)
+        stats.numOut++;
+      else
+        stats.numIO++;
+
+      char const * resolvedType = exec.getExecPortResolvedType(i);
+      if(!resolvedType)
+        continue; // [FE-5538]
+      std::string type = resolvedType;
+      stats.portTypes[type]++;
+
+      // released values are not inspected, that would allocate them again
+      if(stats.released)
+        continue;
+
+      try
+      {
+        addValueStats(stats, type, binding.getArgValue(exec.getExecPortName(i)));
+      }
+      catch(FabricCore::Exception e)
+      {
+        // an argument we can't inspect doesn't count towards the memory
+      }
+    }
+  }
+
+  void collectSpliceStats(FabricSpliceBaseInterface * interf, NodeStats & stats)
+  {
+    stats.kind = "splice";
+    stats.evalCount = interf->getEvalCount();
+    stats.lastExecuteSeconds = interf->getLastExecuteSeconds();
+    stats.totalExecuteSeconds = interf->getTotalExecuteSeconds();
+
+    MPlug saveDataPlug = interf->getSaveDataPlug();
+    if(!saveDataPlug.isNull())
+      stats.saveDataSize = saveDataPlug.asString().length();
+
+    FabricSplice::DGGraph & graph = interf->getSpliceGraph();
+    if(!graph.isValid())
+      return;
+    stats.compiled = true;
+
+    for(unsigned int i=0;i<graph.getDGPortCount();i++)
+    {
+      FabricSplice::DGPort port = graph.getDGPort(i);
+      if(!port.isValid())
+        continue;
+
+      FabricSplice::Port_Mode portMode = port.getMode();
+      if(portMode == FabricSplice::Port_Mode_IN)
+        stats.numIn++;
+      else if(portMode == FabricSplice::Port_Mode_OUT)
+        stats.numOut++;
+      else
+        stats.numIO++;
+
+      std::string type = port.getDataType();
+      if(port.isArray())
+        type += "[]";
+      stats.portTypes[type]++;
+
+      try
+      {
+        addValueStats(stats, type, port.getRTVal());
+      }
+      catch(FabricCore::Exception e)
+      {
+        // an argument we can't inspect doesn't count towards the memory
+      }
+    }
+  }
+
+  std::string encodeString(const std::string & str)
+  {
+    std::string result = "\"";
+    for(size_t i=0;i<str.length();i++)
+    {
+      char c = str[i];
+      if(c == '"' || c == '\\')
+      {
+        result += '\\';
+        result += c;
+      }
+      else if((unsigned char)c < 0x20)
+        result += ' ';
+      else
+        result += c;
+    }
+    result += "\"";
+    return result;
+  }
+
+  void encodeNodeStats(std::stringstream & json, const NodeStats & stats)
+  {
+    json << "{";
+    json << "\"name\":" << encodeString(stats.name);
+    json << ",\"type\":" << encodeString(stats.kind);
+    json << ",\"compiled\":" << (stats.compiled ? "true" : "false");
+    json << ",\"released\":" << (stats.released ? "true" : "false");
+    json << ",\"ports\":{\"in\":" << stats.numIn << ",\"out\":" << stats.numOut << ",\"io\":" << stats.numIO << "}";
+    json << ",\"portTypes\":{";
+    for(std::map<std::string, unsigned int>::const_iterator it = stats.portTypes.begin(); it != stats.portTypes.end(); it++)
+    {
+      if(it != stats.portTypes.begin())
+        json << ",";
+      json << encodeString(it->first) << ":" << it->second;
+    }
+    json << "}";
+    json << ",\"saveDataSize\":" << stats.saveDataSize;
+    json << ",\"arrayElements\":" << stats.arrayElements;
+    json << ",\"meshes\":" << stats.meshCount;
+    json << ",\"meshPoints\":" << stats.meshPoints;
+    json << ",\"meshPolygons\":" << stats.meshPolygons;
+    json << ",\"estimatedBytes\":" << (unsigned long long)stats.estimatedBytes;
+    json << ",\"evalCount\":" << stats.evalCount;
+    json << ",\"lastExecuteMs\":" << stats.lastExecuteSeconds * 1000.0;
+    json << ",\"avgExecuteMs\":" << (stats.evalCount > 0 ? stats.totalExecuteSeconds * 1000.0 / (double)stats.evalCount : 0.0);
+    json << "}";
+  }
+
+  bool isHeavierInMemory(const NodeStats * a, const NodeStats * b)
+  {
+    return a->estimatedBytes > b->estimatedBytes;
+  }
+
+  bool isHeavierInEvaluation(const NodeStats * a, const NodeStats * b)
+  {
+    return a->totalExecuteSeconds > b->totalExecuteSeconds;
+  }
+
+  void encodeTopList(std::stringstream & json, std::vector<const NodeStats *> ranked, bool (*compare)(const NodeStats *, const NodeStats *), unsigned int top)
+  {
+    std::stable_sort(ranked.begin(), ranked.end(), compare);
+    if(ranked.size() > top)
+      ranked.resize(top);
+
+    json << "[";
+    for(size_t i=0;i<ranked.size();i++)
+    {
+      if(i > 0)
+        json << ",";
+      json << encodeString(ranked[i]->name);
+    }
+    json << "]";
+  }
+}
+
+MSyntax FabricCanvasStatsCommand::newSyntax()
+{
+  MSyntax syntax;
+  syntax.addFlag(kNodesFlag, kNodesFlagLong, MSyntax::kString);
+  syntax.addFlag(kTopFlag, kTopFlagLong, MSyntax::kLong);
+  syntax.enableQuery(false);
+  syntax.enableEdit(false);
+  return syntax;
+}
+
+void* FabricCanvasStatsCommand::creator()
+{
+  return new FabricCanvasStatsCommand;
+}
+
+MStatus FabricCanvasStatsCommand::doIt(const MArgList &args)
+{
+  MStatus status;
+  MArgParser argData(syntax(), args, &status);
+
+  std::set<std::string> nodeFilter;
+  if(argData.isFlagSet("nodes"))
+  {
+    MStringArray nodeNames;
+    MString nodes = argData.flagArgumentString("nodes", 0);
+    nodes.split(',', nodeNames);
+    for(unsigned int i=0;i<nodeNames.length();i++)
+      nodeFilter.insert(nodeNames[i].asChar());
+  }
+
+  unsigned int top = 10;
+  if(argData.isFlagSet("top"))
+  {
+    int value = argData.flagArgumentInt("top", 0);
+    top = value > 0 ? (unsigned int)value : 0;
+  }
+
+  std::vector<NodeStats> nodes;
+
+  std::vector<FabricDFGBaseInterface*> dfgInstances = FabricDFGBaseInterface::getInstances();
+  for(size_t i=0;i<dfgInstances.size();i++)
+  {
+    MObject node = dfgInstances[i]->getThisMObject();
+    if(node.isNull())
+      continue;
+    std::string name = MFnDependencyNode(node).name().asChar();
+    if(nodeFilter.size() > 0 && nodeFilter.find(name) == nodeFilter.end())
+      continue;
+
+    NodeStats stats;
+    stats.name = name;
+    collectCanvasStats(dfgInstances[i], stats);
+    nodes.push_back(stats);
+  }
+
+  std::vector<FabricSpliceBaseInterface*> spliceInstances = FabricSpliceBaseInterface::getInstances();
+  for(size_t i=0;i<spliceInstances.size();i++)
+  {
+    MObject node = spliceInstances[i]->getThisMObject();
+    if(node.isNull())
+      continue;
+    std::string name = MFnDependencyNode(node).name().asChar();
+    if(nodeFilter.size() > 0 && nodeFilter.find(name) == nodeFilter.end())
+      continue;
+
+    NodeStats stats;
+    stats.name = name;
+    collectSpliceStats(spliceInstances[i], stats);
+    nodes.push_back(stats);
+  }
+
+  NodeStats totals;
+  std::vector<const NodeStats *> ranked;
+  std::stringstream json;
+  json << "{\"nodes\":[";
+  for(size_t i=0;i<nodes.size();i++)
+  {
+    const NodeStats & stats = nodes[i];
+    if(i > 0)
+      json << ",";
+    encodeNodeStats(json, stats);
+    ranked.push_back(&stats);
+
+    totals.numIn += stats.numIn;
+    totals.numOut += stats.numOut;
+    totals.numIO += stats.numIO;
+    totals.saveDataSize += stats.saveDataSize;
+    totals.arrayElements += stats.arrayElements;
+    totals.meshCount += stats.meshCount;
+    totals.meshPoints += stats.meshPoints;
+    totals.meshPolygons += stats.meshPolygons;
+    totals.estimatedBytes += stats.estimatedBytes;
+    totals.evalCount += stats.evalCount;
+    totals.totalExecuteSeconds += stats.totalExecuteSeconds;
+  }
+  json << "]";
+
+  json << ",\"totals\":{";
+  json << "\"nodes\":" << nodes.size();
+  json << ",\"ports\":{\"in\":" << totals.numIn << ",\"out\":" << totals.numOut << ",\"io\":" << totals.numIO << "}";
+  json << ",\"saveDataSize\":" << totals.saveDataSize;
+  json << ",\"arrayElements\":" << totals.arrayElements;
+  json << ",\"meshes\":" << totals.meshCount;
+  json << ",\"meshPoints\":" << totals.meshPoints;
+  json << ",\"meshPolygons\":" << totals.meshPolygons;
+  json << ",\"estimatedBytes\":" << (unsigned long long)totals.estimatedBytes;
+  json << ",\"evalCount\":" << totals.evalCount;
+  json << ",\"executeMs\":" << totals.totalExecuteSeconds * 1000.0;
+  json << "}";
+
+  json << ",\"topByMemory\":";
+  encodeTopList(json, ranked, isHeavierInMemory, top);
+  json << ",\"topByEvalTime\":";
+  encodeTopList(json, ranked, isHeavierInEvaluation, top);
+  json << "}";
+
+  setResult(MString(json.str().c_str()));
+  return MS::kSuccess;
+}
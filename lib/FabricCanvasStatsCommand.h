@@ -0,0 +1,23 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#pragma once
+
+#include <iostream>
+#include <maya/MPxCommand.h>
+#include <maya/MArgList.h>
+
+// returns a JSON report of the Canvas and Splice nodes in the
+// scene: port counts, saved data size, argument memory and
+// evaluation counts with the time spent executing the graphs (not
+// transfering the values), plus totals and the heaviest nodes
+class FabricCanvasStatsCommand: public MPxCommand{
+public:
+  static void* creator();
+  static MSyntax newSyntax();
+
+  MStatus doIt(const MArgList &args);
+
+private:
+};
@@ -3,12 +3,15 @@
 //
 
 #include "FabricDFGBaseInterface.h"
+#include "FabricDFGBindingCache.h"
 #include "FabricDFGConversion.h"
 #include "FabricSpliceBaseInterface.h"
 #include "FabricSpliceMayaData.h"
 #include "FabricDFGWidget.h"
 #include "FabricSpliceHelpers.h"
 #include "FabricMayaAttrs.h"
+#include "FabricMayaMeshChannel.h"
+#include "FabricDFGRecorder.h"
 #include <Persistence/RTValToJSONEncoder.hpp>
 
 #include <string>
@@ -32,17 +35,24 @@
 #include <maya/MFileObject.h>
 #include <maya/MFnPluginData.h>
 #include <maya/MAnimControl.h>
+#include <maya/MEventMessage.h>
+#include <maya/MTimer.h>
 
 #if _SPLICE_MAYA_VERSION >= 2016
 # include <maya/MEvaluationNode.h>
 #endif
 
 std::vector<FabricDFGBaseInterface*> FabricDFGBaseInterface::_instances;
+std::map<unsigned int, FabricDFGBaseInterface*> FabricDFGBaseInterface::s_instancesById;
+std::multimap<unsigned int, FabricDFGBaseInterface*> FabricDFGBaseInterface::s_instancesByHandle;
+std::map<std::string, FabricDFGBaseInterface*> FabricDFGBaseInterface::s_instancesByName;
 #if _SPLICE_MAYA_VERSION < 2013
   std::map<std::string, int> FabricDFGBaseInterface::_nodeCreatorCounts;
 #endif
 unsigned int FabricDFGBaseInterface::s_maxID = 1;
 bool FabricDFGBaseInterface::s_use_evalContext = true; // [FE-6287]
+int FabricDFGBaseInterface::s_batchDepth = 0;
+MCallbackId FabricDFGBaseInterface::s_idleCallbackId = 0;
 
 FabricDFGBaseInterface::FabricDFGBaseInterface()
   : m_executeSharedDirty( true )
@@ -59,13 +69,25 @@ FabricDFGBaseInterface::FabricDFGBaseInterface()
   _outputsDirtied = false;
   _isReferenced = false;
   _isEvaluating = false;
+  _isEvaluationValid = false;
   _dgDirtyQueued = false;
+  _deferAttributeAffects = false;
   m_evalID = 0;
   m_evalIDAtLastEvaluate = 0;
+  m_evalCount = 0;
+  m_lastExecuteSeconds = 0.0;
+  m_totalExecuteSeconds = 0.0;
+  m_lastEvalTime = 0;
+  m_argMemoryEstimate = 0.0;
+  m_argMemoryEstimateEvalCount = 0;
+  m_argValuesReleased = false;
   m_isStoringJson = false;
+  m_pendingVarsChanged = false;
+  m_bindingCacheKey = 0;
   _instances.push_back(this);
 
   m_id = s_maxID++;
+  s_instancesById.insert(std::pair<unsigned int, FabricDFGBaseInterface*>(m_id, this));
 
   MAYADFG_CATCH_END(&stat);
 }
@@ -77,6 +99,9 @@ FabricDFGBaseInterface::~FabricDFGBaseInterface(){
     m_binding.deallocValues();
 
   m_binding = FabricCore::DFGBinding();
+  if(m_bindingCacheKey != 0)
+    FabricDFGBindingCache::releaseBinding(m_bindingCacheKey);
+  m_bindingCacheKey = 0;
 
   if (s_use_evalContext)
     m_evalContext = FabricCore::RTVal();
@@ -88,6 +113,11 @@ FabricDFGBaseInterface::~FabricDFGBaseInterface(){
       break;
     }
   }
+
+  s_instancesById.erase(m_id);
+  FabricMayaMeshChannel::withdrawNode(m_handle);
+  unregisterHandle();
+  unregisterName();
 }
 
 void FabricDFGBaseInterface::constructBaseInterface(){
@@ -98,6 +128,9 @@ void FabricDFGBaseInterface::constructBaseInterface(){
   if(m_binding.isValid())
     return;
 
+  registerHandle();
+  registerName(MFnDependencyNode(getThisMObject()).name().asChar());
+
 #if _SPLICE_MAYA_VERSION < 2013
   // in earlier versions than 2013 maya would construct each node
   // once on startup. we avoid this by counting the numbers of nodes
@@ -126,31 +159,85 @@ void FabricDFGBaseInterface::constructBaseInterface(){
 
 FabricDFGBaseInterface * FabricDFGBaseInterface::getInstanceByName(const std::string & name) {
 
+  std::map<std::string, FabricDFGBaseInterface*>::iterator it = s_instancesByName.find(name);
+  if(it != s_instancesByName.end())
+    return it->second;
+
+  // fall back to maya for names we don't know,
+  // such as partial names or dag paths
   MSelectionList selList;
-  MGlobal::getSelectionListByName(name.c_str(), selList);
+  if(MGlobal::getSelectionListByName(name.c_str(), selList) != MS::kSuccess)
+    return NULL;
   MObject spliceMayaNodeObj;
-  selList.getDependNode(0, spliceMayaNodeObj);
+  if(selList.getDependNode(0, spliceMayaNodeObj) != MS::kSuccess)
+    return NULL;
+  return getInstanceByMObject(spliceMayaNodeObj);
+}
 
-  for(size_t i=0;i<_instances.size();i++)
+FabricDFGBaseInterface * FabricDFGBaseInterface::getInstanceById(unsigned int id)
+{
+  std::map<unsigned int, FabricDFGBaseInterface*>::iterator it = s_instancesById.find(id);
+  if(it != s_instancesById.end())
+    return it->second;
+  return NULL;
+}
+
+FabricDFGBaseInterface * FabricDFGBaseInterface::getInstanceByMObject(const MObject & node)
+{
+  if(node.isNull())
+    return NULL;
+
+  MObjectHandle handle(node);
+  std::pair<std::multimap<unsigned int, FabricDFGBaseInterface*>::iterator, std::multimap<unsigned int, FabricDFGBaseInterface*>::iterator> range = s_instancesByHandle.equal_range(handle.hashCode());
+  for(std::multimap<unsigned int, FabricDFGBaseInterface*>::iterator it = range.first; it != range.second; it++)
   {
-    if(_instances[i]->getThisMObject() == spliceMayaNodeObj)
-    {
-      return _instances[i];
-    }
+    if(it->second->m_handle == handle)
+      return it->second;
   }
   return NULL;
 }
 
-FabricDFGBaseInterface * FabricDFGBaseInterface::getInstanceById(unsigned int id)
+void FabricDFGBaseInterface::registerHandle()
 {
-  for(size_t i=0;i<_instances.size();i++)
+  MObject node = getThisMObject();
+  if(node.isNull())
+    return;
+  unregisterHandle();
+  m_handle = MObjectHandle(node);
+  s_instancesByHandle.insert(std::pair<unsigned int, FabricDFGBaseInterface*>(m_handle.hashCode(), this));
+}
+
+void FabricDFGBaseInterface::unregisterHandle()
+{
+  // the entry is stored under the hash code of m_handle
+  std::pair<std::multimap<unsigned int, FabricDFGBaseInterface*>::iterator, std::multimap<unsigned int, FabricDFGBaseInterface*>::iterator> range = s_instancesByHandle.equal_range(m_handle.hashCode());
+  for(std::multimap<unsigned int, FabricDFGBaseInterface*>::iterator it = range.first; it != range.second; it++)
   {
-    if(_instances[i]->getId() == id)
+    if(it->second == this)
     {
-      return _instances[i];
+      s_instancesByHandle.erase(it);
+      break;
     }
   }
-  return NULL;
+}
+
+void FabricDFGBaseInterface::registerName(const std::string & name)
+{
+  unregisterName();
+  if(name.empty())
+    return;
+  m_registeredName = name;
+  s_instancesByName[name] = this;
+}
+
+void FabricDFGBaseInterface::unregisterName()
+{
+  if(m_registeredName.empty())
+    return;
+  std::map<std::string, FabricDFGBaseInterface*>::iterator it = s_instancesByName.find(m_registeredName);
+  if(it != s_instancesByName.end() && it->second == this)
+    s_instancesByName.erase(it);
+  m_registeredName.clear();
 }
 
 unsigned int FabricDFGBaseInterface::getNumInstances()
@@ -158,6 +245,11 @@ unsigned int FabricDFGBaseInterface::getNumInstances()
   return (unsigned int)_instances.size();
 }
 
+std::vector<FabricDFGBaseInterface*> FabricDFGBaseInterface::getInstances()
+{
+  return _instances;
+}
+
 unsigned int FabricDFGBaseInterface::getId() const
 {
   return m_id;
@@ -190,6 +282,9 @@ bool FabricDFGBaseInterface::transferInputValuesToDFG(MDataBlock& data){
 
   FTL::AutoSet<bool> transfersInputs(_isTransferingInputs, true);
 
+  // the released values are restored by the transfer of the dirty plugs
+  m_argValuesReleased = false;
+
   MFnDependencyNode thisNode(getThisMObject());
 
   FabricCore::DFGExec exec = getDFGExec();
@@ -227,6 +322,7 @@ bool FabricDFGBaseInterface::transferInputValuesToDFG(MDataBlock& data){
         
         DFGPlugToArgFunc func = getDFGPlugToArgFunc(portDataType);
         if(func != NULL)
+        {
           (*func)(
             plug,
             data,
@@ -235,6 +331,8 @@ bool FabricDFGBaseInterface::transferInputValuesToDFG(MDataBlock& data){
             portName.asChar(),
             &timers
             );
+          addRecordedInput(portName.asChar());
+        }
       }
     }
   }
@@ -249,6 +347,7 @@ void FabricDFGBaseInterface::evaluate(){
   FTL::AutoSet<bool> transfersInputs(_isEvaluating, true);
   _dgDirtyQueued = false;
   m_evalIDAtLastEvaluate = m_evalID;
+  _isEvaluationValid = false;
 
   MFnDependencyNode thisNode(getThisMObject());
 
@@ -277,6 +376,7 @@ void FabricDFGBaseInterface::evaluate(){
         m_evalContext.setMember("graph", FabricCore::RTVal::ConstructString(m_client, thisNode.name().asChar()));
         m_evalContext.setMember("time", FabricCore::RTVal::ConstructFloat32(m_client, MAnimControl::currentTime().as(MTime::kSeconds)));
         m_evalContext.setMember("currentFilePath", FabricCore::RTVal::ConstructString(m_client, mayaGetLastLoadedScene().asChar()));
+        reportDirtyInputsToEvalContext();
       }
       catch(FabricCore::Exception e)
       {
@@ -284,11 +384,110 @@ void FabricDFGBaseInterface::evaluate(){
       }
     }
   }
+  _evalContextDirtyInputs.clear();
+
+  if(FabricDFGRecorder::isRecording())
+    FabricDFGRecorder::recordEvaluation(this, m_recordedInputs);
+  m_recordedInputs.clear();
 
+  MTimer executeTimer;
+  executeTimer.beginTimer();
   m_binding.execute_lockType( getLockType() );
+  executeTimer.endTimer();
+
+  m_evalCount++;
+  m_lastExecuteSeconds = executeTimer.elapsedTime();
+  m_totalExecuteSeconds += m_lastExecuteSeconds;
+  m_lastEvalTime = time(NULL);
+  _isEvaluationValid = true;
+}
+
+void FabricDFGBaseInterface::addRecordedInput(const std::string & argName)
+{
+  if(!FabricDFGRecorder::isRecording())
+    return;
+  if(std::find(m_recordedInputs.begin(), m_recordedInputs.end(), argName) == m_recordedInputs.end())
+    m_recordedInputs.push_back(argName);
+}
+
+bool FabricDFGBaseInterface::isEvaluationValid() const
+{
+  // the outputs of the last evaluation can still be
+  // used as long as no input nor the graph has changed
+  return _isEvaluationValid
+    && !_portObjectsDestroyed
+    && _dirtyPlugs.length() == 0
+    && m_evalID == m_evalIDAtLastEvaluate;
+}
+
+MString FabricDFGBaseInterface::getRequestedPortName(const MPlug &plug)
+{
+  MPlug rootPlug = plug;
+  while(!rootPlug.isNull())
+  {
+    if(rootPlug.isChild())
+      rootPlug = rootPlug.parent();
+    else if(rootPlug.isElement())
+      rootPlug = rootPlug.array();
+    else
+      break;
+  }
+  if(rootPlug.isNull())
+    return MString();
+
+  MFnAttribute attr(rootPlug.attribute());
+  return getPortName(attr.name());
+}
+
+void FabricDFGBaseInterface::reportDirtyInputsToEvalContext(){
+
+  FabricSplice::Logging::AutoTimer timer("Maya::reportDirtyInputsToEvalContext()");
+
+  // the dirty ports are reported in a single call: their names,
+  // the number of dirty elements of each of them (zero when the
+  // whole port is dirty) and the dirty elements of all ports
+  FabricCore::DFGExec exec = getDFGExec();
+  std::vector<std::string> portNames;
+  std::vector<uint32_t> indexCounts;
+  std::vector<int32_t> allIndices;
+  std::map<std::string, std::vector<int> >::iterator it;
+  for(it = _evalContextDirtyInputs.begin(); it != _evalContextDirtyInputs.end(); it++)
+  {
+    std::string portName = getPortName(it->first.c_str()).asChar();
+    if(!exec.haveExecPort(portName.c_str()))
+      continue;
+    if(exec.getExecPortType(portName.c_str()) == FabricCore::DFGPortType_Out)
+      continue;
+
+    portNames.push_back(portName);
+    std::vector<int> & indices = it->second;
+    if(indices.size() == 0 || indices[0] == -1)
+    {
+      indexCounts.push_back(0);
+      continue;
+    }
+
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    indexCounts.push_back((uint32_t)indices.size());
+    allIndices.insert(allIndices.end(), indices.begin(), indices.end());
+  }
+
+  if(portNames.size() == 0)
+    return;
+
+  dfgLoadMayaExtension();
+  FabricCore::RTVal args[3];
+  args[0] = FabricCore::RTVal::ConstructVariableArray(m_client, "String");
+  args[0].setArraySize((uint32_t)portNames.size());
+  for(size_t i=0;i<portNames.size();i++)
+    args[0].setArrayElement((uint32_t)i, FabricCore::RTVal::ConstructString(m_client, portNames[i].c_str()));
+  args[1] = FabricCore::RTVal::ConstructExternalArray(m_client, "UInt32", indexCounts.size(), &indexCounts[0]);
+  args[2] = FabricCore::RTVal::ConstructExternalArray(m_client, "SInt32", allIndices.size(), allIndices.size() > 0 ? &allIndices[0] : NULL);
+  m_evalContext.callMethod("", "_addDirtyInputs", 3, &args[0]);
 }
 
-void FabricDFGBaseInterface::transferOutputValuesToMaya(MDataBlock& data, bool isDeformer){
+void FabricDFGBaseInterface::transferOutputValuesToMaya(MDataBlock& data, bool isDeformer, const MString & requestedPortName){
   if(_isTransferingInputs)
     return;
 
@@ -306,6 +505,12 @@ void FabricDFGBaseInterface::transferOutputValuesToMaya(MDataBlock& data, bool i
     if(portType != FabricCore::DFGPortType_In){
       
       std::string portName = exec.getExecPortName(i);
+
+      // only convert the output maya asked for, the others
+      // are converted when they are pulled on themselves
+      if(requestedPortName.length() > 0 && requestedPortName != portName.c_str())
+        continue;
+
       std::string plugName = getPlugName(portName.c_str()).asChar();
       std::string portDataType = exec.getExecPortResolvedType(i);
 
@@ -346,7 +551,7 @@ void FabricDFGBaseInterface::transferOutputValuesToMaya(MDataBlock& data, bool i
   }
 }
 
-void FabricDFGBaseInterface::collectDirtyPlug(MPlug const &inPlug){
+void FabricDFGBaseInterface::collectDirtyPlug(MPlug const &inPlug, int elementIndex){
 
   FabricSplice::Logging::AutoTimer timer("Maya::collectDirtyPlug()");
 
@@ -365,27 +570,35 @@ void FabricDFGBaseInterface::collectDirtyPlug(MPlug const &inPlug){
   if(name == "saveData" || name == "refFilePath")
     return;
 
-  // if(_spliceGraph.usesEvalContext())
-  // {
-  //   _evalContextPlugNames.append(name);
-  //   if(inPlug.isElement())
-  //     _evalContextPlugIds.append(inPlug.logicalIndex());
-  //   else
-  //     _evalContextPlugIds.append(-1);
-  // }
+  _isEvaluationValid = false;
 
   if(inPlug.isChild()){
     // if plug belongs to translation or rotation we collect the parent to transfer all x,y,z values
     if(inPlug.parent().isElement()){
-      collectDirtyPlug(inPlug.parent().array());
+      collectDirtyPlug(inPlug.parent().array(), inPlug.parent().logicalIndex());
       return;
     }
     else{
-      collectDirtyPlug(inPlug.parent());
+      collectDirtyPlug(inPlug.parent(), elementIndex);
       return;
     }
   }
 
+  if(s_use_evalContext)
+  {
+    if(inPlug.isElement())
+      elementIndex = inPlug.logicalIndex();
+
+    std::vector<int> & indices = _evalContextDirtyInputs[name.asChar()];
+    if(indices.size() != 1 || indices[0] != -1)
+    {
+      if(elementIndex < 0)
+        indices.assign(1, -1);
+      else if(indices.size() == 0 || indices.back() != elementIndex)
+        indices.push_back(elementIndex);
+    }
+  }
+
   for(size_t i = 0; i < _dirtyPlugs.length(); ++i){
     if(_dirtyPlugs[i] == name)
       return;
@@ -446,29 +659,14 @@ void FabricDFGBaseInterface::restoreFromPersistenceData(MString file, MStatus *s
     if(resolvedRefFilePath != refFilePath)
       mayaLogFunc("Referenced file path '"+refFilePath+"' resolved to '"+resolvedRefFilePath+"'.");
 
-    FILE * file = fopen(resolvedRefFilePath.asChar(), "rb");
-    if(!file)
+    std::string content;
+    if(!FabricDFGBindingCache::readFile(resolvedRefFilePath, content))
     {
       mayaLogErrorFunc("Referenced file path '"+refFilePath+"' cannot be opened, falling back to locally saved json.");
     }
     else
     {
-      fseek( file, 0, SEEK_END );
-      long fileSize = ftell( file );
-      rewind( file );
-
-      char * buffer = (char*) malloc(fileSize + 1);
-      buffer[fileSize] = '\0';
-
-      size_t readBytes = fread(buffer, 1, fileSize, file);
-      assert(readBytes == size_t(fileSize));
-      (void)readBytes;
-
-      fclose(file);
-
-      json = buffer;
-      free(buffer);
-
+      json = content.c_str();
       _isReferenced = true;
     }
   }
@@ -487,7 +685,10 @@ void FabricDFGBaseInterface::restoreFromJSON(MString json, MStatus *stat){
   FabricSplice::Logging::AutoTimer timer("Maya::restoreFromPersistenceData()");
 
   FabricCore::DFGHost dfgHost = m_client.getDFGHost();
-  m_binding = dfgHost.createBindingFromJSON(json.asChar());
+  uint64_t previousCacheKey = m_bindingCacheKey;
+  m_binding = FabricDFGBindingCache::createBinding(dfgHost, json.asChar(), m_bindingCacheKey);
+  if(previousCacheKey != 0)
+    FabricDFGBindingCache::releaseBinding(previousCacheKey);
   m_binding.setNotificationCallback( BindingNotificationCallback, this );
 
   FTL::StrRef execPath;
@@ -503,107 +704,106 @@ void FabricDFGBaseInterface::restoreFromJSON(MString json, MStatus *stat){
   invalidateNode();
 
   MFnDependencyNode thisNode(getThisMObject());
+  std::string localTimerName = (std::string("Maya::")+thisNode.name().asChar()+"::restoreFromPersistenceData()").c_str();
+  FabricSplice::Logging::AutoTimer localTimer(localTimerName.c_str());
 
+  // gather the port metadata once, only the ports
+  // without an attribute yet need to be restored
+  std::vector<RestorePortInfo> ports;
   for(unsigned i = 0; i < exec.getExecPortCount(); ++i){
-    std::string portName = exec.getExecPortName(i);
-    MString plugName = getPlugName(portName.c_str());
-    MPlug plug = thisNode.findPlug(plugName);
-    if(!plug.isNull())
+    RestorePortInfo port;
+    port.name = exec.getExecPortName(i);
+    port.plugName = getPlugName(port.name.c_str());
+    port.portType = exec.getExecPortType(i);
+    port.attribute = thisNode.attribute(port.plugName);
+    port.isNew = false;
+    if(!port.attribute.isNull())
+    {
+      ports.push_back(port);
       continue;
+    }
 
-    FabricCore::DFGPortType portType = exec.getExecPortType(i);
     if (!exec.getExecPortResolvedType(i)) continue; // [FE-5538]
-    std::string dataType = exec.getExecPortResolvedType(i);
+    port.dataType = exec.getExecPortResolvedType(i);
 
-    FTL::StrRef opaque = exec.getExecPortMetadata(portName.c_str(), "opaque");
+    FTL::StrRef opaque = exec.getExecPortMetadata(port.name.c_str(), "opaque");
     if(opaque == "true")
-      dataType = "SpliceMayaData";
+      port.dataType = "SpliceMayaData";
 
-    FabricServices::CodeCompletion::KLTypeDesc typeDesc(dataType);
+    FabricServices::CodeCompletion::KLTypeDesc typeDesc(port.dataType);
 
-    std::string arrayType = "Single Value";
+    port.arrayType = "Single Value";
     if(typeDesc.isArray())
     {
-      arrayType = "Array (Multi)";
-      FTL::StrRef nativeArray = exec.getExecPortMetadata(portName.c_str(), "nativeArray");
+      port.arrayType = "Array (Multi)";
+      FTL::StrRef nativeArray = exec.getExecPortMetadata(port.name.c_str(), "nativeArray");
       if(nativeArray == "true")
       {
-        arrayType = "Array (Native)";
-        exec.setExecPortMetadata(portName.c_str(), "nativeArray", "true", false);
+        port.arrayType = "Array (Native)";
+        exec.setExecPortMetadata(port.name.c_str(), "nativeArray", "true", false);
       }
     }
 
-    FTL::StrRef addAttribute = exec.getExecPortMetadata(portName.c_str(), "addAttribute");
-    if(addAttribute != "false")
-      addMayaAttribute(portName.c_str(), dataType.c_str(), portType, arrayType.c_str());
+    FTL::StrRef addAttribute = exec.getExecPortMetadata(port.name.c_str(), "addAttribute");
+    port.isNew = addAttribute != "false";
+    ports.push_back(port);
+  }
 
-    if(portType != FabricCore::DFGPortType_Out)
-    {
-      MFnDependencyNode thisNode(getThisMObject());
-      MPlug plug = thisNode.findPlug(plugName);
-      if(!plug.isNull())
-      {
-        FabricCore::RTVal value = m_binding.getArgValue(portName.c_str());
-        std::string typeName = value.getTypeName().getStringCString();
-        if(typeName == "String")
-          plug.setString(value.getStringCString());
-        else if(typeName == "Boolean")
-          plug.setBool(value.getBoolean());
-        else if(!value.isValid())
-          continue;
-        else if(value.isArray())
+  // create all of the attributes, their affects are
+  // wired below in one pass instead of once per attribute
+  {
+    FTL::AutoSet<bool> deferAffects(_deferAttributeAffects, true);
+    for(size_t i = 0; i < ports.size(); ++i){
+      RestorePortInfo & port = ports[i];
+      if(!port.isNew)
+        continue;
+      port.attribute = addMayaAttribute(port.name.c_str(), port.dataType.c_str(), port.portType, port.arrayType.c_str());
+      if(port.attribute.isNull())
+        port.isNew = false;
+    }
+  }
+
+  // inputs and IO ports affect all outputs and IO ports,
+  // pairs of existing attributes have been wired before
+  MPxNode * userNode = thisNode.userNode();
+  if(userNode != NULL)
+  {
+    FabricSplice::Logging::AutoTimer affectsTimer("Maya::setupMayaAttributeAffects()");
+    for(size_t i = 0; i < ports.size(); ++i){
+      const RestorePortInfo & src = ports[i];
+      if(src.attribute.isNull() || src.portType == FabricCore::DFGPortType_Out)
+        continue;
+      for(size_t j = 0; j < ports.size(); ++j){
+        const RestorePortInfo & dst = ports[j];
+        if(dst.attribute.isNull() || dst.portType == FabricCore::DFGPortType_In)
           continue;
-        else if(value.isDict())
+        if(!src.isNew && !dst.isNew)
           continue;
-        else
-        {
-          float fvalue = 0.0;
-          if(typeName == "SInt8")
-            fvalue = (float)value.getSInt8();
-          else if(typeName == "SInt16")
-            fvalue = (float)value.getSInt16();
-          else if(typeName == "SInt32")
-            fvalue = (float)value.getSInt32();
-          else if(typeName == "SInt64")
-            fvalue = (float)value.getSInt64();
-          else if(typeName == "UInt8")
-            fvalue = (float)value.getUInt8();
-          else if(typeName == "UInt16")
-            fvalue = (float)value.getUInt16();
-          else if(typeName == "UInt32")
-            fvalue = (float)value.getUInt32();
-          else if(typeName == "UInt64")
-            fvalue = (float)value.getUInt64();
-          else if(typeName == "Float32")
-            fvalue = (float)value.getFloat32();
-          else if(typeName == "Float64")
-            fvalue = (float)value.getFloat64();
-
-          MDataHandle handle = plug.asMDataHandle();
-          if(handle.numericType() == MFnNumericData::kFloat)
-            plug.setFloat(fvalue);
-          else if(handle.numericType() == MFnNumericData::kDouble)
-            plug.setDouble(fvalue);
-          else if(handle.numericType() == MFnNumericData::kInt)
-            plug.setInt((int)fvalue);
-        }
+        userNode->attributeAffects(src.attribute, dst.attribute);
       }
     }
   }
 
-  for(unsigned i = 0; i < exec.getExecPortCount(); ++i){
-    std::string portName = exec.getExecPortName(i);
-    MString plugName = getPlugName(portName.c_str());
-    MPlug plug = thisNode.findPlug(plugName);
+  // initialize the new input attributes from the argument values
+  for(size_t i = 0; i < ports.size(); ++i){
+    const RestorePortInfo & port = ports[i];
+    if(!port.isNew || port.portType == FabricCore::DFGPortType_Out)
+      continue;
+    MPlug plug(getThisMObject(), port.attribute);
     if(plug.isNull())
       continue;
+    setPlugFromArgValue(plug, port.dataType, m_binding.getArgValue(port.name.c_str()));
+  }
+
+  for(size_t i = 0; i < ports.size(); ++i){
+    if(ports[i].attribute.isNull())
+      continue;
 
     // force an execution of the node    
-    FabricCore::DFGPortType portType = exec.getExecPortType(i);
-    if(portType != FabricCore::DFGPortType_Out)
+    if(ports[i].portType != FabricCore::DFGPortType_Out)
     {
       MString command("dgeval ");
-      MGlobal::executeCommandOnIdle(command+thisNode.name()+"."+plugName);
+      MGlobal::executeCommandOnIdle(command+thisNode.name()+"."+ports[i].plugName);
       break;
     }
   }
@@ -614,6 +814,97 @@ void FabricDFGBaseInterface::restoreFromJSON(MString json, MStatus *stat){
   MAYADFG_CATCH_END(stat);
 }
 
+void FabricDFGBaseInterface::setPlugFromArgValue(MPlug &plug, const std::string &dataType, FabricCore::RTVal value)
+{
+  enum ValueKind
+  {
+    ValueKind_String,
+    ValueKind_Boolean,
+    ValueKind_SInt8,
+    ValueKind_SInt16,
+    ValueKind_SInt32,
+    ValueKind_SInt64,
+    ValueKind_UInt8,
+    ValueKind_UInt16,
+    ValueKind_UInt32,
+    ValueKind_UInt64,
+    ValueKind_Float32,
+    ValueKind_Float64
+  };
+
+  static std::map<std::string, int> kinds;
+  if(kinds.empty())
+  {
+    kinds["String"] = ValueKind_String;
+    kinds["Boolean"] = ValueKind_Boolean;
+    kinds["SInt8"] = ValueKind_SInt8;
+    kinds["SInt16"] = ValueKind_SInt16;
+    kinds["SInt32"] = ValueKind_SInt32;
+    kinds["Integer"] = ValueKind_SInt32;
+    kinds["SInt64"] = ValueKind_SInt64;
+    kinds["UInt8"] = ValueKind_UInt8;
+    kinds["Byte"] = ValueKind_UInt8;
+    kinds["UInt16"] = ValueKind_UInt16;
+    kinds["UInt32"] = ValueKind_UInt32;
+    kinds["Size"] = ValueKind_UInt32;
+    kinds["Index"] = ValueKind_UInt32;
+    kinds["Count"] = ValueKind_UInt32;
+    kinds["UInt64"] = ValueKind_UInt64;
+    kinds["Float32"] = ValueKind_Float32;
+    kinds["Scalar"] = ValueKind_Float32;
+    kinds["Float64"] = ValueKind_Float64;
+  }
+
+  if(!value.isValid())
+    return;
+
+  // the resolved type of the port spares the type name lookup
+  // of the value, which is only used for unknown aliases
+  std::map<std::string, int>::const_iterator it = kinds.find(dataType);
+  if(it == kinds.end())
+  {
+    if(value.isArray() || value.isDict())
+      return;
+    it = kinds.find(value.getTypeName().getStringCString());
+    if(it == kinds.end())
+      return;
+  }
+
+  double dvalue = 0.0;
+  switch(it->second)
+  {
+    case ValueKind_String:
+      plug.setString(value.getStringCString());
+      return;
+    case ValueKind_Boolean:
+      plug.setBool(value.getBoolean());
+      return;
+    case ValueKind_SInt8: dvalue = (double)value.getSInt8(); break;
+    case ValueKind_SInt16: dvalue = (double)value.getSInt16(); break;
+    case ValueKind_SInt32: dvalue = (double)value.getSInt32(); break;
+    case ValueKind_SInt64: dvalue = (double)value.getSInt64(); break;
+    case ValueKind_UInt8: dvalue = (double)value.getUInt8(); break;
+    case ValueKind_UInt16: dvalue = (double)value.getUInt16(); break;
+    case ValueKind_UInt32: dvalue = (double)value.getUInt32(); break;
+    case ValueKind_UInt64: dvalue = (double)value.getUInt64(); break;
+    case ValueKind_Float32: dvalue = (double)value.getFloat32(); break;
+    case ValueKind_Float64: dvalue = value.getFloat64(); break;
+  }
+
+  MStatus numericStatus;
+  MFnNumericAttribute nAttr(plug.attribute(), &numericStatus);
+  if(numericStatus != MS::kSuccess)
+    return;
+
+  MFnNumericData::Type numericType = nAttr.unitType();
+  if(numericType == MFnNumericData::kFloat)
+    plug.setFloat((float)dvalue);
+  else if(numericType == MFnNumericData::kDouble)
+    plug.setDouble(dvalue);
+  else if(numericType == MFnNumericData::kInt)
+    plug.setInt((int)dvalue);
+}
+
 void FabricDFGBaseInterface::setReferencedFilePath(MString filePath)
 {
   MPlug plug = getRefFilePathPlug();
@@ -719,6 +1010,9 @@ void FabricDFGBaseInterface::invalidatePlug(MPlug & plug)
 
 void FabricDFGBaseInterface::invalidateNode()
 {
+  // the graph may have changed
+  FabricDFGRecorder::invalidateBinding(m_id);
+
   if(!_dgDirtyEnabled)
     return;
   FabricSplice::Logging::AutoTimer timer("Maya::invalidateNode()");
@@ -784,6 +1078,7 @@ void FabricDFGBaseInterface::invalidateNode()
 
   _affectedPlugsDirty = true;
   _outputsDirtied = false;
+  _isEvaluationValid = false;
 }
 
 void FabricDFGBaseInterface::incrementEvalID()
@@ -873,7 +1168,7 @@ MStatus FabricDFGBaseInterface::setDependentsDirty(MObject thisMObject, MPlug co
 void FabricDFGBaseInterface::copyInternalData(MPxNode *node){
   if (node)
   {
-    FabricDFGBaseInterface *otherInterface = getInstanceByName(node->name().asChar());
+    FabricDFGBaseInterface *otherInterface = getInstanceByMObject(node->thisMObject());
     if (otherInterface)
     {
       MStatus stat = MS::kSuccess;
@@ -918,9 +1213,10 @@ bool FabricDFGBaseInterface::setInternalValueInContext(const MPlug &plug, const
 
 void FabricDFGBaseInterface::onNodeAdded(MObject &node, void *clientData)
 {
-  MFnDependencyNode thisNode(node);
-  FabricDFGBaseInterface * interf = getInstanceByName(thisNode.name().asChar());
+  FabricDFGBaseInterface * interf = getInstanceByMObject(node);
   if( interf ) {
+    interf->registerName(MFnDependencyNode(node).name().asChar());
+
     interf->managePortObjectValues( false ); // reattach
 
     // In case it is from the delete of an undo, 
@@ -931,15 +1227,29 @@ void FabricDFGBaseInterface::onNodeAdded(MObject &node, void *clientData)
 
 void FabricDFGBaseInterface::onNodeRemoved(MObject &node, void *clientData)
 {
-  MFnDependencyNode thisNode(node);
-  FabricDFGBaseInterface * interf = getInstanceByName(thisNode.name().asChar());
+  FabricDFGBaseInterface * interf = getInstanceByMObject(node);
 
   if(interf)
+  {
+    // the node stays alive on the undo queue,
+    // but its name may be taken by a new node now.
+    interf->unregisterName();
     interf->managePortObjectValues(true); // detach
+  }
+}
+
+void FabricDFGBaseInterface::onNodeRenamed(MObject &node, const MString &prevName, void *clientData)
+{
+  FabricDFGBaseInterface * interf = getInstanceByMObject(node);
+  if(interf)
+    interf->registerName(MFnDependencyNode(node).name().asChar());
 }
 
 void FabricDFGBaseInterface::onAnimCurveEdited(MObjectArray &editedCurves, void *clientData)
 {
+  if(s_instancesByHandle.empty())
+    return;
+
   for (unsigned int i=0;i<editedCurves.length();i++)
   {
     // get the curve and its connected plugs.
@@ -963,13 +1273,7 @@ void FabricDFGBaseInterface::onAnimCurveEdited(MObjectArray &editedCurves, void
       for (unsigned int k=0;k<destPlugs.length();k++)
       {
         MPlug &destPlug = destPlugs[k];
-
-        std::string n = destPlug.name().asChar();
-        size_t t = n.find_last_of('.');
-        if (t == std::string::npos)
-          continue;
-
-        FabricDFGBaseInterface *b = getInstanceByName(n.substr(0, t).c_str());
+        FabricDFGBaseInterface *b = getInstanceByMObject(destPlug.node());
         if (b)  b->invalidatePlug(destPlug);
       }
     }
@@ -980,6 +1284,15 @@ void FabricDFGBaseInterface::onConnection(const MPlug &plug, const MPlug &otherP
 {
   _affectedPlugsDirty = true;
 
+  // a mesh output which was handed to Fabric nodes only
+  // has to be converted again for the new consumer
+  if(asSrc && made && FabricMayaMeshChannel::isPublished(plug) &&
+    !FabricMayaMeshChannel::isFabricConsumer(otherPlug))
+  {
+    FabricMayaMeshChannel::withdraw(plug);
+    MGlobal::executeCommandOnIdle("dgdirty " + plug.name());
+  }
+
   if(!asSrc)
   {
     MString plugName = plug.name();
@@ -1433,6 +1746,78 @@ MObject FabricDFGBaseInterface::addMayaAttribute(MString portName, MString dataT
       return newAttribute;
     }
   }
+  else if(FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_Vec2)
+  {
+    if(arrayType == "Single Value" || arrayType == "Array (Multi)")
+    {
+      MObject x = nAttr.create(plugName+"X", plugName+"X", MFnNumericData::kDouble);
+      nAttr.setStorable(storable);
+      nAttr.setKeyable(storable);
+      MObject y = nAttr.create(plugName+"Y", plugName+"Y", MFnNumericData::kDouble);
+      nAttr.setStorable(storable);
+      nAttr.setKeyable(storable);
+
+      newAttribute = nAttr.create(plugName, plugName, x, y);
+      if(arrayType == "Array (Multi)")
+      {
+        nAttr.setArray(true);
+        nAttr.setUsesArrayDataBuilder(true);
+      }
+    }
+    else
+    {
+      mayaLogErrorFunc("DataType '"+dataType+"' incompatible with ArrayType '"+arrayType+"'.");
+      return newAttribute;
+    }
+  }
+  else if(FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_Vec4 ||
+    FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_Quat)
+  {
+    if(arrayType == "Single Value" || arrayType == "Array (Multi)")
+    {
+      newAttribute = nAttr.create(plugName, plugName, MFnNumericData::k4Double);
+      if(FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_Quat)
+        nAttr.setDefault(0.0, 0.0, 0.0, 1.0);
+      if(arrayType == "Array (Multi)")
+      {
+        nAttr.setArray(true);
+        nAttr.setUsesArrayDataBuilder(true);
+      }
+    }
+    else
+    {
+      mayaLogErrorFunc("DataType '"+dataType+"' incompatible with ArrayType '"+arrayType+"'.");
+      return newAttribute;
+    }
+  }
+  else if((FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_Xfo ||
+    FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_Mat44) &&
+    portType == FabricCore::DFGPortType_Out && arrayType != "Single Value" &&
+    FTL::StrRef(exec.getExecPortMetadata(portName.asChar(), "instancer")) == "true")
+  {
+    // transforms for the instancer, converted in bulk
+    // to its particle data instead of a matrix per element
+    newAttribute = tAttr.create(plugName, plugName, MFnData::kDynArrayAttrs);
+    storable = false;
+  }
+  else if(FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_Xfo)
+  {
+    if(arrayType == "Single Value")
+    {
+      newAttribute = mAttr.create(plugName, plugName);
+    }
+    else if(arrayType == "Array (Multi)")
+    {
+      newAttribute = mAttr.create(plugName, plugName);
+      mAttr.setArray(true);
+      mAttr.setUsesArrayDataBuilder(true);
+    }
+    else
+    {
+      mayaLogErrorFunc("DataType '"+dataType+"' incompatible with ArrayType '"+arrayType+"'.");
+      return newAttribute;
+    }
+  }
   else if(FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_Mat44)
   {
     if(arrayType == "Single Value")
@@ -1491,6 +1876,42 @@ MObject FabricDFGBaseInterface::addMayaAttribute(MString portName, MString dataT
       return newAttribute;
     }
   }
+  else if(FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_Curves)
+  {
+    // one nurbsCurve per curve of the Curves object
+    if(arrayType == "Single Value")
+    {
+      newAttribute = tAttr.create(plugName, plugName, MFnData::kNurbsCurve);
+      storable = false;
+      tAttr.setArray(true);
+      tAttr.setUsesArrayDataBuilder(true);
+    }
+    else
+    {
+      mayaLogErrorFunc("DataType '"+dataType+"' incompatible with ArrayType '"+arrayType+"'.");
+      return newAttribute;
+    }
+  }
+  else if(FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_Points)
+  {
+    if(arrayType == "Single Value")
+    {
+      newAttribute = tAttr.create(plugName, plugName, MFnData::kDynArrayAttrs);
+      storable = false;
+    }
+    else if(arrayType == "Array (Multi)")
+    {
+      newAttribute = tAttr.create(plugName, plugName, MFnData::kDynArrayAttrs);
+      storable = false;
+      tAttr.setArray(true);
+      tAttr.setUsesArrayDataBuilder(true);
+    }
+    else
+    {
+      mayaLogErrorFunc("DataType '"+dataType+"' incompatible with ArrayType '"+arrayType+"'.");
+      return newAttribute;
+    }
+  }
   else if(FabricMaya::ParseDataType(dataTypeOverride.asChar()) == FabricMaya::DT_KeyframeTrack){
     
     if(arrayType == "Single Value")
@@ -1608,7 +2029,7 @@ MObject FabricDFGBaseInterface::addMayaAttribute(MString portName, MString dataT
       thisNode.addAttribute(newAttribute);
   }
 
-  if(!compoundChild)
+  if(!compoundChild && !_deferAttributeAffects)
     setupMayaAttributeAffects(portName, portType, newAttribute);
 
   _affectedPlugsDirty = true;
@@ -1735,6 +2156,219 @@ void FabricDFGBaseInterface::managePortObjectValues(bool destroy)
   _portObjectsDestroyed = destroy;
 }
 
+// true if all of the values of the plug come from connections, the
+// values set on unconnected plugs may only live in the binding
+static bool isPlugDrivenByConnections(const MPlug & plug)
+{
+  if(plug.isDestination())
+    return true;
+  if(plug.isArray())
+    return plug.numElements() > 0 && plug.numConnectedElements() == plug.numElements();
+  if(plug.isCompound())
+    return plug.numChildren() > 0 && plug.numConnectedChildren() == plug.numChildren();
+  return false;
+}
+
+void FabricDFGBaseInterface::releaseArgValues()
+{
+  if(m_argValuesReleased || _portObjectsDestroyed || _isEvaluating || _isTransferingInputs)
+    return;
+  if(!m_binding.isValid())
+    return;
+
+  // only the values Maya can give back are released: the inputs
+  // driven by connections, which are transfered again on the next
+  // compute, and the outputs which have been converted to their
+  // plug, which are evaluated again when pulled on. IO ports, inputs
+  // set on unconnected plugs (through the Canvas UI, dfgSetArgValue...)
+  // and values without a plug or conversion are kept.
+  MFnDependencyNode thisNode(getThisMObject());
+  FabricCore::Client client = getCoreClient();
+  FabricCore::DFGExec exec = getDFGExec();
+  bool releasedOutputs = false;
+  for(unsigned int i = 0; i < exec.getExecPortCount(); ++i){
+    FabricCore::DFGPortType portType = exec.getExecPortType(i);
+    if(portType == FabricCore::DFGPortType_IO)
+      continue;
+    char const * resolvedType = exec.getExecPortResolvedType(i);
+    if(!resolvedType)
+      continue; // [FE-5538]
+    char const * portName = exec.getExecPortName(i);
+    MString plugName = getPlugName(portName);
+    MPlug plug = thisNode.findPlug(plugName);
+    if(plug.isNull())
+      continue;
+
+    std::string portDataType(resolvedType);
+    if(portDataType.length() > 2 && portDataType.substr(portDataType.length()-2, 2) == "[]")
+      portDataType = portDataType.substr(0, portDataType.length()-2);
+    for(size_t j=0;j<mSpliceMayaDataOverride.size();j++)
+    {
+      if(mSpliceMayaDataOverride[j] == portName)
+      {
+        portDataType = "SpliceMayaData";
+        break;
+      }
+    }
+
+    if(portType == FabricCore::DFGPortType_In){
+      if(getDFGPlugToArgFunc(portDataType) == NULL || !isPlugDrivenByConnections(plug))
+        continue;
+    }
+    else if(getDFGArgToPlugFunc(portDataType) == NULL)
+      continue;
+
+    try
+    {
+      m_binding.setArgValue_lockType(getLockType(), portName,
+        FabricCore::RTVal::Construct(client, resolvedType, 0, 0), false);
+    }
+    catch(FabricCore::Exception e)
+    {
+      // keep the values we can't reset
+      continue;
+    }
+
+    if(portType != FabricCore::DFGPortType_In){
+      releasedOutputs = true;
+      continue;
+    }
+
+    bool isDirty = false;
+    for(unsigned int j = 0; j < _dirtyPlugs.length(); ++j){
+      if(_dirtyPlugs[j] == plugName){
+        isDirty = true;
+        break;
+      }
+    }
+    if(!isDirty)
+      collectDirtyPlug(plug);
+  }
+
+  // the outputs which haven't been pulled yet are
+  // gone, they have to be evaluated again
+  if(releasedOutputs)
+    _isEvaluationValid = false;
+
+  m_argValuesReleased = true;
+  m_argMemoryEstimate = 0.0;
+}
+
+bool FabricDFGBaseInterface::isNodeDisabled()
+{
+  MObject node = getThisMObject();
+  if(node.isNull())
+    return false;
+  MPlug statePlug = MFnDependencyNode(node).findPlug("nodeState");
+  if(statePlug.isNull())
+    return false;
+  // 1 is HasNoEffect, 2 is Blocking, the
+  // states of newer Maya versions are ignored
+  short state = statePlug.asShort();
+  return state == 1 || state == 2;
+}
+
+double FabricDFGBaseInterface::getArgMemoryEstimate()
+{
+  if(m_argValuesReleased || _portObjectsDestroyed || !m_binding.isValid())
+    return 0.0;
+  if(m_argMemoryEstimateEvalCount == m_evalCount && m_argMemoryEstimate > 0.0)
+    return m_argMemoryEstimate;
+
+  double estimate = 0.0;
+  FabricCore::DFGExec exec = getDFGExec();
+  for(unsigned int i = 0; i < exec.getExecPortCount(); ++i){
+    char const * resolvedType = exec.getExecPortResolvedType(i);
+    if(!resolvedType)
+      continue; // [FE-5538]
+    try
+    {
+      estimate += estimateValueMemory(resolvedType, m_binding.getArgValue(i));
+    }
+    catch(FabricCore::Exception e)
+    {
+      // ignore values we can't inspect
+    }
+  }
+
+  m_argMemoryEstimate = estimate;
+  m_argMemoryEstimateEvalCount = m_evalCount;
+  return m_argMemoryEstimate;
+}
+
+double FabricDFGBaseInterface::estimateValueMemory(const std::string & type, FabricCore::RTVal value)
+{
+  if(!value.isValid())
+    return 0.0;
+
+  // rough size of the common POD types, everything else
+  // is counted as a pointer sized value
+  static std::map<std::string, unsigned int> sizes;
+  if(sizes.empty())
+  {
+    sizes["Boolean"] = 1;
+    sizes["UInt8"] = 1;
+    sizes["SInt8"] = 1;
+    sizes["Byte"] = 1;
+    sizes["UInt16"] = 2;
+    sizes["SInt16"] = 2;
+    sizes["UInt32"] = 4;
+    sizes["SInt32"] = 4;
+    sizes["Integer"] = 4;
+    sizes["Size"] = 4;
+    sizes["Index"] = 4;
+    sizes["Float32"] = 4;
+    sizes["Scalar"] = 4;
+    sizes["UInt64"] = 8;
+    sizes["SInt64"] = 8;
+    sizes["Float64"] = 8;
+    sizes["Vec2"] = 8;
+    sizes["Vec3"] = 12;
+    sizes["Vec4"] = 16;
+    sizes["Color"] = 16;
+    sizes["RGB"] = 3;
+    sizes["RGBA"] = 4;
+    sizes["Quat"] = 16;
+    sizes["Euler"] = 16;
+    sizes["Mat22"] = 16;
+    sizes["Mat33"] = 36;
+    sizes["Mat44"] = 64;
+    sizes["Xfo"] = 40;
+  }
+
+  std::string baseType = type;
+  size_t bracket = baseType.find('[');
+  if(bracket != std::string::npos)
+    baseType = baseType.substr(0, bracket);
+
+  if(value.isArray())
+  {
+    unsigned int size = value.getArraySize();
+    if(baseType == "PolygonMesh")
+    {
+      double estimate = 0.0;
+      for(unsigned int i=0;i<size;i++)
+        estimate += estimateValueMemory(baseType, value.getArrayElement(i));
+      return estimate;
+    }
+    std::map<std::string, unsigned int>::const_iterator it = sizes.find(baseType);
+    return (double)size * (double)(it != sizes.end() ? it->second : 8);
+  }
+
+  if(baseType == "PolygonMesh")
+  {
+    if(value.isNullObject())
+      return 0.0;
+    double points = value.callMethod("UInt32", "pointCount", 0, 0).getUInt32();
+    double polygons = value.callMethod("UInt32", "polygonCount", 0, 0).getUInt32();
+    // positions, normals and the topology, roughly four corners per polygon
+    return points * 24.0 + polygons * 4.0 * 12.0;
+  }
+
+  std::map<std::string, unsigned int>::const_iterator it = sizes.find(baseType);
+  return it != sizes.end() ? it->second : 8;
+}
+
 void FabricDFGBaseInterface::allStorePersistenceData(MString file, MStatus *stat)
 {
   for(size_t i=0;i<_instances.size();i++)
@@ -1755,6 +2389,7 @@ void FabricDFGBaseInterface::allResetInternalData()
     _instances[i]->_isTransferingInputs = false;
     _instances[i]->_dgDirtyEnabled = true;
     _instances[i]->_portObjectsDestroyed = false;
+    _instances[i]->m_argValuesReleased = false;
     _instances[i]->_affectedPlugsDirty = true;
     _instances[i]->_outputsDirtied = false;
     // todo: eventually destroy the binding
@@ -1762,12 +2397,86 @@ void FabricDFGBaseInterface::allResetInternalData()
   }
 }
 
-void FabricDFGBaseInterface::bindingNotificationCallback(
-  FTL::CStrRef jsonStr
+// returns the string value of a top level key of a notification, without
+// decoding the whole JSON. returns false if the key can't be found or the
+// value isn't a plain string, the caller then falls back to the full decode.
+static bool getNotificationString(
+  FTL::CStrRef jsonStr,
+  char const *key,
+  std::string &value
   )
 {
-  // MGlobal::displayInfo(jsonStr.data());
+  std::string pattern = std::string("\"") + key + "\"";
+  char const *begin = jsonStr.data();
+  char const *end = begin + jsonStr.size();
+  char const *p = std::search(begin, end, pattern.begin(), pattern.end());
+  if(p == end)
+    return false;
+  p += pattern.length();
+  while(p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+    p++;
+  if(p == end || *p++ != ':')
+    return false;
+  while(p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+    p++;
+  if(p == end || *p++ != '"')
+    return false;
+
+  value.clear();
+  for(;p < end;p++)
+  {
+    if(*p == '"')
+      return true;
+    if(*p == '\\')
+      return false;
+    value += *p;
+  }
+  return false;
+}
+
+bool FabricDFGBaseInterface::parseBindingNotification(
+  FTL::CStrRef jsonStr,
+  PendingNotification &notification
+  )
+{
+  std::string desc;
+  if(!getNotificationString(jsonStr, "desc", desc))
+    return parseBindingNotificationJSON(jsonStr, notification);
 
+  if(desc == "dirty")
+    notification.kind = PendingNotification::Dirty;
+  else if(desc == "argTypeChanged")
+  {
+    notification.kind = PendingNotification::ArgTypeChanged;
+    if(!getNotificationString(jsonStr, "name", notification.name)
+      || !getNotificationString(jsonStr, "newType", notification.type))
+      return parseBindingNotificationJSON(jsonStr, notification);
+  }
+  else if(desc == "argRemoved")
+  {
+    notification.kind = PendingNotification::ArgRemoved;
+    if(!getNotificationString(jsonStr, "name", notification.name))
+      return parseBindingNotificationJSON(jsonStr, notification);
+  }
+  else if(desc == "argRenamed")
+  {
+    notification.kind = PendingNotification::ArgRenamed;
+    if(!getNotificationString(jsonStr, "oldName", notification.name)
+      || !getNotificationString(jsonStr, "newName", notification.newName))
+      return parseBindingNotificationJSON(jsonStr, notification);
+  }
+  else if(desc == "varInserted" || desc == "varRemoved")
+    notification.kind = PendingNotification::VarsChanged;
+  else
+    return false;
+  return true;
+}
+
+bool FabricDFGBaseInterface::parseBindingNotificationJSON(
+  FTL::CStrRef jsonStr,
+  PendingNotification &notification
+  )
+{
   FTL::JSONStrWithLoc jsonStrWithLoc( jsonStr );
   FTL::OwnedPtr<FTL::JSONObject const> jsonObject(
     FTL::JSONValue::Decode( jsonStrWithLoc )->cast<FTL::JSONObject>()
@@ -1776,19 +2485,185 @@ void FabricDFGBaseInterface::bindingNotificationCallback(
   FTL::CStrRef descStr = jsonObject->getString( FTL_STR("desc") );
 
   if ( descStr == FTL_STR("dirty") )
+    notification.kind = PendingNotification::Dirty;
+  else if( descStr == FTL_STR("argTypeChanged") )
+  {
+    notification.kind = PendingNotification::ArgTypeChanged;
+    notification.name = jsonObject->getString( FTL_STR("name") );
+    notification.type = jsonObject->getString( FTL_STR("newType") );
+  }
+  else if( descStr == FTL_STR("argRemoved") )
+  {
+    notification.kind = PendingNotification::ArgRemoved;
+    notification.name = jsonObject->getString( FTL_STR("name") );
+  }
+  else if( descStr == FTL_STR("argRenamed") )
+  {
+    notification.kind = PendingNotification::ArgRenamed;
+    notification.name = jsonObject->getString( FTL_STR("oldName") );
+    notification.newName = jsonObject->getString( FTL_STR("newName") );
+  }
+  else if(   descStr == FTL_STR("varInserted")
+          || descStr == FTL_STR("varRemoved") )
+    notification.kind = PendingNotification::VarsChanged;
+  else
+    return false;
+  return true;
+}
+
+void FabricDFGBaseInterface::bindingNotificationCallback(
+  FTL::CStrRef jsonStr
+  )
+{
+  // MGlobal::displayInfo(jsonStr.data());
+
+  PendingNotification notification;
+  if(!parseBindingNotification(jsonStr, notification))
+    return;
+
+  if(notification.kind == PendingNotification::Dirty)
   {
     if(!_isEvaluating && !_isTransferingInputs)
     {
       // when we receive this notification we need to 
-      // ensure that the DCC reevaluates the node
+      // ensure that the DCC reevaluates the node.
+      // incrementEvalID only bumps once per evaluation,
+      // so a burst of dirties results in a single bump.
       incrementEvalID();
+
+      // the arguments or the graph were changed outside of a compute,
+      // through the Canvas UI, a command or releaseArgValues. The next
+      // recorded evaluation writes the binding with all of its inputs.
+      FabricDFGRecorder::invalidateBinding(getId());
     }
+    return;
   }
-  else if( descStr == FTL_STR("argTypeChanged") )
+
+  if(notification.kind == PendingNotification::VarsChanged)
+  {
+    m_pendingVarsChanged = true;
+  }
+  else
+  {
+    if(notification.kind == PendingNotification::ArgTypeChanged)
+    {
+      // only keep the last type change of a port, as long as
+      // the port wasn't renamed or removed in between
+      for(size_t i=m_pendingNotifications.size();i-->0;)
+      {
+        PendingNotification const &prev = m_pendingNotifications[i];
+        if(prev.name == notification.name)
+        {
+          if(prev.kind == PendingNotification::ArgTypeChanged)
+            m_pendingNotifications.erase(m_pendingNotifications.begin() + i);
+          break;
+        }
+        if(prev.kind == PendingNotification::ArgRenamed
+          && prev.newName == notification.name)
+          break;
+      }
+    }
+    m_pendingNotifications.push_back(notification);
+  }
+
+  // the notifications are applied at the end of the current
+  // command, at the end of the batch or on idle otherwise
+  if(s_batchDepth == 0 && s_idleCallbackId == 0)
+    s_idleCallbackId = MEventMessage::addEventCallback("idle", &onIdle);
+}
+
+void FabricDFGBaseInterface::flushPendingNotifications()
+{
+  std::vector<PendingNotification> notifications;
+  notifications.swap(m_pendingNotifications);
+  for(size_t i=0;i<notifications.size();i++)
   {
-    std::string nameStr = jsonObject->getString( FTL_STR("name") );
+    MStatus stat;
+    MAYADFG_CATCH_BEGIN(&stat);
+    applyBindingNotification(notifications[i]);
+    MAYADFG_CATCH_END(&stat);
+  }
+
+  if(m_pendingVarsChanged)
+  {
+    m_pendingVarsChanged = false;
+    if (   FabricDFGWidget::Instance()
+        && FabricDFGWidget::Instance()->getDfgWidget()
+        && FabricDFGWidget::Instance()->getDfgWidget()->getUIController())
+    FabricDFGWidget::Instance()->getDfgWidget()->getUIController()->emitVarsChanged();
+  }
+}
+
+void FabricDFGBaseInterface::flushAllPendingNotifications()
+{
+  if(s_idleCallbackId != 0)
+  {
+    MMessage::removeCallback(s_idleCallbackId);
+    s_idleCallbackId = 0;
+  }
+
+  std::map<unsigned int, FabricDFGBaseInterface*>::iterator it;
+  for(it = s_instancesById.begin(); it != s_instancesById.end(); it++)
+    it->second->flushPendingNotifications();
+}
+
+void FabricDFGBaseInterface::onIdle(void *clientData)
+{
+  // batches are closed by the script which opened them,
+  // so one still open on idle was left open by an error
+  if(s_batchDepth > 0)
+  {
+    MGlobal::displayWarning("FabricCanvasBeginBatch: a batch was left open, closing it.");
+    s_batchDepth = 1;
+    endBatch();
+    return;
+  }
+  flushAllPendingNotifications();
+}
+
+void FabricDFGBaseInterface::beginBatch()
+{
+  if(s_batchDepth++ > 0)
+    return;
+  MGlobal::executeCommand("undoInfo -openChunk -chunkName \"FabricCanvasBatch\"", false, false);
+  if(s_idleCallbackId == 0)
+    s_idleCallbackId = MEventMessage::addEventCallback("idle", &onIdle);
+}
+
+void FabricDFGBaseInterface::resetBatch()
+{
+  if(s_batchDepth == 0)
+    return;
+  s_batchDepth = 0;
+  flushAllPendingNotifications();
+  MGlobal::executeCommand("undoInfo -closeChunk", false, false);
+}
+
+bool FabricDFGBaseInterface::endBatch()
+{
+  if(s_batchDepth == 0)
+    return false;
+  if(--s_batchDepth > 0)
+    return true;
+
+  FabricSplice::Logging::AutoTimer timer("Maya::endBatch()");
+
+  flushAllPendingNotifications();
+
+  MGlobal::executeCommand("undoInfo -closeChunk", false, false);
+  MGlobal::executeCommandOnIdle("file -modified true", false);
+  return true;
+}
+
+void FabricDFGBaseInterface::applyBindingNotification(
+  PendingNotification const &notification
+  )
+{
+  if( notification.kind == PendingNotification::ArgTypeChanged )
+  {
+    std::string nameStr = notification.name;
     MString plugName = getPlugName(nameStr.c_str());
-    std::string newTypeStr = jsonObject->getString( FTL_STR("newType") );
+    std::string newTypeStr = notification.type;
 
     MFnDependencyNode thisNode(getThisMObject());
 
@@ -1808,13 +2683,15 @@ void FabricDFGBaseInterface::bindingNotificationCallback(
     }
 
     FabricCore::DFGExec exec = getDFGExec();
+    if(!exec.haveExecPort(nameStr.c_str()))
+      return;
     FabricCore::DFGPortType portType = exec.getExecPortType(nameStr.c_str());
     addMayaAttribute(nameStr.c_str(), newTypeStr.c_str(), portType);
     _argTypes.insert(std::pair<std::string, std::string>(nameStr, newTypeStr));
   }
-  else if( descStr == FTL_STR("argRemoved") )
+  else if( notification.kind == PendingNotification::ArgRemoved )
   {
-    std::string nameStr = jsonObject->getString( FTL_STR("name") );
+    std::string nameStr = notification.name;
     MString plugName = getPlugName(nameStr.c_str());
 
     MFnDependencyNode thisNode(getThisMObject());
@@ -1824,11 +2701,11 @@ void FabricDFGBaseInterface::bindingNotificationCallback(
     if(!plug.isNull())
       removeMayaAttribute(nameStr.c_str());
   }
-  else if( descStr == FTL_STR("argRenamed") )
+  else if( notification.kind == PendingNotification::ArgRenamed )
   {
-    std::string oldNameStr = jsonObject->getString( FTL_STR("oldName") );
+    std::string oldNameStr = notification.name;
     MString oldPlugName = getPlugName(oldNameStr.c_str());
-    std::string newNameStr = jsonObject->getString( FTL_STR("newName") );
+    std::string newNameStr = notification.newName;
     MString newPlugName = getPlugName(newNameStr.c_str());
 
     MFnDependencyNode thisNode(getThisMObject());
@@ -1837,21 +2714,6 @@ void FabricDFGBaseInterface::bindingNotificationCallback(
     MPlug plug = thisNode.findPlug(oldPlugName);
     renamePlug(plug, oldPlugName, newPlugName);
   }
-  else if( descStr == FTL_STR("argInserted") )
-  {
-  }
-  else if(   descStr == FTL_STR("varInserted")
-          || descStr == FTL_STR("varRemoved") )
-  {
-    if (   FabricDFGWidget::Instance()
-        && FabricDFGWidget::Instance()->getDfgWidget()
-        && FabricDFGWidget::Instance()->getDfgWidget()->getUIController())
-    FabricDFGWidget::Instance()->getDfgWidget()->getUIController()->emitVarsChanged();
-  }
-  // else
-  // {
-  //   mayaLogFunc(jsonStr.c_str());
-  // }
 }
 
 void FabricDFGBaseInterface::renamePlug(const MPlug &plug, MString oldName, MString newName)
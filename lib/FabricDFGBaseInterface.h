@@ -10,12 +10,15 @@
 #include "DFGUICmdHandler_Maya.h"
 
 #include <vector>
+#include <map>
+#include <ctime>
 
 #include <maya/MFnDependencyNode.h> 
 #include <maya/MPlug.h> 
 #include <maya/MPxNode.h> 
 #include <maya/MTypeId.h> 
 #include <maya/MNodeMessage.h>
+#include <maya/MObjectHandle.h>
 #include <maya/MStringArray.h>
 #include <maya/MFnCompoundAttribute.h>
 
@@ -50,7 +53,9 @@ public:
 
   static FabricDFGBaseInterface * getInstanceByName(const std::string & name);
   static FabricDFGBaseInterface * getInstanceById(unsigned int id);
+  static FabricDFGBaseInterface * getInstanceByMObject(const MObject & node);
   static unsigned int getNumInstances();
+  static std::vector<FabricDFGBaseInterface*> getInstances();
 
   virtual MObject getThisMObject() = 0;
   virtual MPlug getSaveDataPlug() = 0;
@@ -73,6 +78,7 @@ public:
 
   static void onNodeAdded(MObject &node, void *clientData);
   static void onNodeRemoved(MObject &node, void *clientData);
+  static void onNodeRenamed(MObject &node, const MString &prevName, void *clientData);
   static void onAnimCurveEdited(MObjectArray &editedCurves, void *clientData);
 
   void managePortObjectValues(bool destroy);
@@ -92,6 +98,44 @@ public:
   void setExecuteSharedDirty()
     { m_executeSharedDirty = true; }
 
+  // while a batch is open the binding notifications are deferred
+  // and the Maya attributes are reconciled once in endBatch
+  static void beginBatch();
+  static bool endBatch();
+  // closes a batch left open without marking the scene
+  // as modified, called when a scene is created or opened
+  static void resetBatch();
+  static bool isInBatch()
+    { return s_batchDepth > 0; }
+
+  // applies the queued binding notifications of all instances,
+  // called at the end of each command and on idle
+  static void flushAllPendingNotifications();
+
+  // evaluation statistics, reported by the FabricCanvasStats command.
+  // the seconds only cover the execution of the binding, the transfer
+  // and conversion of the values are in the Maya:: AutoTimers
+  unsigned int getEvalCount() const
+    { return m_evalCount; }
+  double getLastExecuteSeconds() const
+    { return m_lastExecuteSeconds; }
+  double getTotalExecuteSeconds() const
+    { return m_totalExecuteSeconds; }
+  time_t getLastEvalTime() const
+    { return m_lastEvalTime; }
+
+  // releases the values of the inputs driven by connections and of the
+  // outputs converted to their plug, Maya gives them back on the next
+  // compute. the other argument values are kept
+  void releaseArgValues();
+  bool areArgValuesReleased() const
+    { return m_argValuesReleased; }
+  bool isNodeDisabled();
+
+  // rough size in bytes of the argument values, see estimateValueMemory
+  double getArgMemoryEstimate();
+  static double estimateValueMemory(const std::string & type, FabricCore::RTVal value);
+
 protected:
   inline MString getPlugName(const MString &portName);
   inline MString getPortName(const MString &plugName);
@@ -103,16 +147,25 @@ protected:
 
   // FabricSplice::DGGraph _spliceGraph;
   MStringArray _dirtyPlugs;
-  MStringArray _evalContextPlugNames;
-  MIntArray _evalContextPlugIds;
+  // dirty inputs reported to the EvalContext, by port
+  // name with the dirty element indices, -1 for the whole port
+  std::map<std::string, std::vector<int> > _evalContextDirtyInputs;
   bool _isTransferingInputs;
   bool _portObjectsDestroyed;
   std::vector<std::string> mSpliceMayaDataOverride;
+  // the arguments set since the last evaluation, while recording
+  std::vector<std::string> m_recordedInputs;
 
   bool transferInputValuesToDFG(MDataBlock& data);
+  // marks an argument set outside of transferInputValuesToDFG
+  // as an input of the next evaluation for FabricDFGRecorder
+  void addRecordedInput(const std::string & argName);
   void evaluate();
-  void transferOutputValuesToMaya(MDataBlock& data, bool isDeformer = false);
-  void collectDirtyPlug(MPlug const &inPlug);
+  void transferOutputValuesToMaya(MDataBlock& data, bool isDeformer = false, const MString & requestedPortName = MString());
+  bool isEvaluationValid() const;
+  MString getRequestedPortName(const MPlug &plug);
+  void collectDirtyPlug(MPlug const &inPlug, int elementIndex = -1);
+  void reportDirtyInputsToEvalContext();
   void affectChildPlugs(MPlug &plug, MPlugArray &affectedPlugs);
   void copyInternalData(MPxNode *node);
   bool getInternalValueInContext(const MPlug &plug, MDataHandle &dataHandle, MDGContext &ctx);
@@ -141,9 +194,18 @@ protected:
   bool _outputsDirtied;
   bool _isReferenced;
   bool _isEvaluating;
+  bool _isEvaluationValid;
   bool _dgDirtyQueued;
+  bool _deferAttributeAffects;
   unsigned int m_evalID;
   unsigned int m_evalIDAtLastEvaluate;
+  unsigned int m_evalCount;
+  double m_lastExecuteSeconds;
+  double m_totalExecuteSeconds;
+  time_t m_lastEvalTime;
+  double m_argMemoryEstimate;
+  unsigned int m_argMemoryEstimateEvalCount;
+  bool m_argValuesReleased;
   MPlugArray _affectedPlugs;
 
 #if _SPLICE_MAYA_VERSION < 2013
@@ -151,6 +213,12 @@ protected:
 #endif
   static std::vector<FabricDFGBaseInterface*> _instances;
 
+  // lookup tables for the instances, the names are kept
+  // up to date through the node added, removed and renamed callbacks
+  static std::map<unsigned int, FabricDFGBaseInterface*> s_instancesById;
+  static std::multimap<unsigned int, FabricDFGBaseInterface*> s_instancesByHandle;
+  static std::map<std::string, FabricDFGBaseInterface*> s_instancesByName;
+
   FabricCore::Client m_client;
   FabricServices::ASTWrapper::KLASTManager * m_manager;
   FabricCore::DFGBinding m_binding;
@@ -160,7 +228,30 @@ protected:
 
 private:
 
+  // a binding notification, reduced to what the node needs
+  struct PendingNotification
+  {
+    enum Kind
+    {
+      Dirty,
+      ArgTypeChanged,
+      ArgRemoved,
+      ArgRenamed,
+      VarsChanged
+    };
+
+    Kind kind;
+    std::string name;
+    std::string newName;
+    std::string type;
+  };
+
   void bindingNotificationCallback( FTL::CStrRef jsonStr );
+  static bool parseBindingNotification( FTL::CStrRef jsonStr, PendingNotification &notification );
+  static bool parseBindingNotificationJSON( FTL::CStrRef jsonStr, PendingNotification &notification );
+  void applyBindingNotification( PendingNotification const &notification );
+  void flushPendingNotifications();
+  static void onIdle( void *clientData );
   static void BindingNotificationCallback(
     void * userData, char const *jsonCString, uint32_t jsonLength
     )
@@ -172,16 +263,43 @@ private:
       );
   }
 
+  // a port gathered by restoreFromJSON
+  struct RestorePortInfo
+  {
+    std::string name;
+    MString plugName;
+    FabricCore::DFGPortType portType;
+    std::string dataType;
+    std::string arrayType;
+    MObject attribute;
+    bool isNew;
+  };
+
+  static void setPlugFromArgValue(MPlug &plug, const std::string &dataType, FabricCore::RTVal value);
+
   bool plugInArray(const MPlug &plug, const MPlugArray &array);
   void renamePlug(const MPlug &plug, MString oldName, MString newName);
   static MString resolveEnvironmentVariables(const MString & filePath);
 
+  void registerHandle();
+  void unregisterHandle();
+  void registerName(const std::string & name);
+  void unregisterName();
+
   unsigned int m_id;
   static unsigned int s_maxID;
+  MObjectHandle m_handle;
+  std::string m_registeredName;
   bool m_executeSharedDirty;
   bool m_executeShared;
   MString m_lastJson;
+  // the key of m_binding in FabricDFGBindingCache, 0 if not cached
+  uint64_t m_bindingCacheKey;
   bool m_isStoringJson;
+  std::vector<PendingNotification> m_pendingNotifications;
+  bool m_pendingVarsChanged;
+  static int s_batchDepth;
+  static MCallbackId s_idleCallbackId;
 
 // [FE-6287]
 public:
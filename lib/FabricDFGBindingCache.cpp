@@ -0,0 +1,157 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#include "FabricDFGBindingCache.h"
+#include "FabricSpliceHelpers.h"
+#include <FabricSplice.h>
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+std::map<std::string, FabricDFGBindingCache::FileEntry> FabricDFGBindingCache::s_files;
+std::multimap<uint64_t, FabricDFGBindingCache::BindingEntry> FabricDFGBindingCache::s_bindings;
+std::map<uint64_t, uint64_t> FabricDFGBindingCache::s_bindingHashes;
+uint64_t FabricDFGBindingCache::s_maxBindingKey = 0;
+
+bool FabricDFGBindingCache::readFile(const MString & filePath, std::string & content)
+{
+  struct stat fileStat;
+  if(stat(filePath.asChar(), &fileStat) != 0)
+    return false;
+
+  std::string key = filePath.asChar();
+  std::map<std::string, FileEntry>::iterator it = s_files.find(key);
+  if(it != s_files.end())
+  {
+    if(it->second.mtime == (int64_t)fileStat.st_mtime && it->second.size == (int64_t)fileStat.st_size)
+    {
+      content = it->second.content;
+      return true;
+    }
+    s_files.erase(it);
+  }
+
+  FabricSplice::Logging::AutoTimer timer("Maya::FabricDFGBindingCache::readFile()");
+
+  FILE * file = fopen(filePath.asChar(), "rb");
+  if(!file)
+    return false;
+
+  fseek( file, 0, SEEK_END );
+  long fileSize = ftell( file );
+  rewind( file );
+
+  FileEntry entry;
+  entry.mtime = (int64_t)fileStat.st_mtime;
+  entry.size = (int64_t)fileStat.st_size;
+  entry.content.resize(fileSize);
+
+  size_t readBytes = fileSize > 0 ? fread(&entry.content[0], 1, fileSize, file) : 0;
+  fclose(file);
+  if(readBytes != size_t(fileSize))
+    return false;
+
+  // the referenced file used to be read as a c string
+  size_t nullPos = entry.content.find('\0');
+  if(nullPos != std::string::npos)
+    entry.content.resize(nullPos);
+
+  content = entry.content;
+  s_files.insert(std::pair<std::string, FileEntry>(key, entry));
+  return true;
+}
+
+FabricCore::DFGBinding FabricDFGBindingCache::createBinding(FabricCore::DFGHost & dfgHost, const std::string & json, uint64_t & cacheKey)
+{
+  uint64_t hash = hashJSON(json);
+
+  std::pair<std::multimap<uint64_t, BindingEntry>::iterator, std::multimap<uint64_t, BindingEntry>::iterator> range = s_bindings.equal_range(hash);
+  for(std::multimap<uint64_t, BindingEntry>::iterator it = range.first; it != range.second; it++)
+  {
+    if(it->second.json != json)
+      continue;
+
+    // the template binding keeps the compiled code of the
+    // graph alive, so this only instantiates the graph
+    FabricSplice::Logging::AutoTimer timer("Maya::FabricDFGBindingCache::createBinding() cached");
+    FabricCore::DFGBinding binding = dfgHost.createBindingFromJSON(json.c_str());
+    if(!it->second.templateBinding.isValid())
+    {
+      // the graph is used by a second node, the template is made
+      // from the first instance, without the values of its arguments
+      it->second.templateBinding = dfgHost.createBindingFromJSON(json.c_str());
+      it->second.templateBinding.deallocValues();
+    }
+    it->second.numInstances++;
+    cacheKey = it->second.key;
+    return binding;
+  }
+
+  FabricSplice::Logging::AutoTimer timer("Maya::FabricDFGBindingCache::createBinding()");
+
+  // graphs used by a single node don't get a template,
+  // the node's own binding keeps the code compiled
+  BindingEntry entry;
+  entry.key = ++s_maxBindingKey;
+  entry.json = json;
+  entry.numInstances = 1;
+
+  FabricCore::DFGBinding binding = dfgHost.createBindingFromJSON(json.c_str());
+  s_bindings.insert(std::pair<uint64_t, BindingEntry>(hash, entry));
+  s_bindingHashes[entry.key] = hash;
+  cacheKey = entry.key;
+  return binding;
+}
+
+void FabricDFGBindingCache::releaseBinding(uint64_t cacheKey)
+{
+  std::map<uint64_t, uint64_t>::iterator hashIt = s_bindingHashes.find(cacheKey);
+  if(hashIt == s_bindingHashes.end())
+    return;
+
+  std::pair<std::multimap<uint64_t, BindingEntry>::iterator, std::multimap<uint64_t, BindingEntry>::iterator> range = s_bindings.equal_range(hashIt->second);
+  for(std::multimap<uint64_t, BindingEntry>::iterator it = range.first; it != range.second; it++)
+  {
+    if(it->second.key != cacheKey)
+      continue;
+    if(it->second.numInstances > 1)
+    {
+      it->second.numInstances--;
+      return;
+    }
+    s_bindings.erase(it);
+    break;
+  }
+  s_bindingHashes.erase(hashIt);
+}
+
+void FabricDFGBindingCache::clear()
+{
+  s_files.clear();
+  s_bindings.clear();
+  s_bindingHashes.clear();
+}
+
+unsigned int FabricDFGBindingCache::getNumFiles()
+{
+  return (unsigned int)s_files.size();
+}
+
+unsigned int FabricDFGBindingCache::getNumBindings()
+{
+  return (unsigned int)s_bindings.size();
+}
+
+uint64_t FabricDFGBindingCache::hashJSON(const std::string & json)
+{
+  // FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for(size_t i=0;i<json.length();i++)
+  {
+    hash ^= (uint64_t)(unsigned char)json[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
@@ -0,0 +1,61 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#pragma once
+
+#include <FabricCore.h>
+#include <maya/MString.h>
+
+#include <map>
+#include <string>
+
+// Process wide cache shared by all Canvas nodes.
+// Referenced files are only read again when their modification
+// time or size changes. Once a second node instantiates the same
+// graph json, a private template binding is kept alive, which is
+// never handed out, so that the compiled code stays resident in the
+// core for the nodes instantiating that json. The values of its
+// arguments are deallocated. The template is dropped when the last
+// node using it releases its binding.
+class FabricDFGBindingCache
+{
+public:
+
+  static bool readFile(const MString & filePath, std::string & content);
+
+  // instantiates the json, the returned key has to be
+  // handed to releaseBinding once the binding is dropped
+  static FabricCore::DFGBinding createBinding(FabricCore::DFGHost & dfgHost, const std::string & json, uint64_t & cacheKey);
+  static void releaseBinding(uint64_t cacheKey);
+
+  static void clear();
+  static unsigned int getNumFiles();
+  static unsigned int getNumBindings();
+
+private:
+
+  static uint64_t hashJSON(const std::string & json);
+
+  struct FileEntry
+  {
+    int64_t mtime;
+    int64_t size;
+    std::string content;
+  };
+
+  struct BindingEntry
+  {
+    uint64_t key;
+    std::string json;
+    FabricCore::DFGBinding templateBinding;
+    unsigned int numInstances;
+  };
+
+  static std::map<std::string, FileEntry> s_files;
+  // by hash of the json
+  static std::multimap<uint64_t, BindingEntry> s_bindings;
+  // the hash of the json by key
+  static std::map<uint64_t, uint64_t> s_bindingHashes;
+  static uint64_t s_maxBindingKey;
+};
@@ -7,6 +7,7 @@
 #include "Foundation.h"
 #include "FabricDFGCommands.h"
 #include "FabricSpliceHelpers.h"
+#include "DFGUICmdHandler_Maya.h"
 
 #include <FabricUI/DFG/DFGUICmdHandler.h>
 
@@ -116,6 +117,13 @@ MStatus FabricDFGCoreCommand::doIt( const MArgList &args )
     }
   }
 
+  // within a batch the notifications are applied and
+  // the scene is flagged as modified once in endBatch
+  if (FabricDFGBaseInterface::isInBatch())
+    return status;
+
+  FabricDFGBaseInterface::flushAllPendingNotifications();
+
   if (status != MS::kFailure)
   {
     /* [FE-6195]
@@ -144,6 +152,8 @@ MStatus FabricDFGCoreCommand::undoIt()
     logError( e.getDesc_cstr() );
     status = MS::kFailure;
   }
+  if (!FabricDFGBaseInterface::isInBatch())
+    FabricDFGBaseInterface::flushAllPendingNotifications();
   return status;
 }
 
@@ -159,6 +169,8 @@ MStatus FabricDFGCoreCommand::redoIt()
     logError( e.getDesc_cstr() );
     status = MS::kFailure;
   }
+  if (!FabricDFGBaseInterface::isInBatch())
+    FabricDFGBaseInterface::flushAllPendingNotifications();
   return status;
 }
 
@@ -1285,6 +1297,7 @@ void FabricDFGSetArgValueCommand::AddSyntax( MSyntax &syntax )
   syntax.addFlag("-n", "-argName", MSyntax::kString);
   syntax.addFlag("-t", "-type", MSyntax::kString);
   syntax.addFlag("-v", "-value", MSyntax::kString);
+  syntax.addFlag("-vh", "-valueHandle", MSyntax::kLong);
 }
 
 void FabricDFGSetArgValueCommand::GetArgs(
@@ -1302,6 +1315,16 @@ void FabricDFGSetArgValueCommand::GetArgs(
     throw ArgException( MS::kFailure, "-type not provided." );
   MString type = argParser.flagArgumentString( "type", 0 ).asChar();
 
+  // prefer the snapshot passed by the command handler, the JSON is
+  // only there for commands replayed from the script editor
+  if ( argParser.isFlagSet( "valueHandle" ) )
+  {
+    unsigned int handle =
+      (unsigned int)argParser.flagArgumentInt( "valueHandle", 0 );
+    if ( DFGUICmdHandler_Maya::takeValueSnapshot( handle, args.value ) )
+      return;
+  }
+
   if ( !argParser.isFlagSet( "value" ) )
     throw ArgException( MS::kFailure, "-value not provided." );
   MString valueJSON = argParser.flagArgumentString( "value", 0 ).asChar();
@@ -1336,6 +1359,7 @@ void FabricDFGSetPortDefaultValueCommand::AddSyntax( MSyntax &syntax )
   syntax.addFlag("-p", "-portPath", MSyntax::kString);
   syntax.addFlag("-t", "-type", MSyntax::kString);
   syntax.addFlag("-v", "-value", MSyntax::kString);
+  syntax.addFlag("-vh", "-valueHandle", MSyntax::kLong);
 }
 
 void FabricDFGSetPortDefaultValueCommand::GetArgs(
@@ -1353,6 +1377,14 @@ void FabricDFGSetPortDefaultValueCommand::GetArgs(
     throw ArgException( MS::kFailure, "-t (-type) not provided." );
   MString type = argParser.flagArgumentString( "type", 0 ).asChar();
 
+  if ( argParser.isFlagSet( "valueHandle" ) )
+  {
+    unsigned int handle =
+      (unsigned int)argParser.flagArgumentInt( "valueHandle", 0 );
+    if ( DFGUICmdHandler_Maya::takeValueSnapshot( handle, args.value ) )
+      return;
+  }
+
   if ( !argParser.isFlagSet( "value" ) )
     throw ArgException( MS::kFailure, "-v (-value) not provided." );
   MString valueJSON = argParser.flagArgumentString( "value", 0 ).asChar();
@@ -2165,3 +2197,39 @@ MStatus FabricCanvasSetExecuteSharedCommand::redoIt()
 
   return MS::kSuccess;
 }
+
+// FabricCanvasBeginBatchCommand
+
+MSyntax FabricCanvasBeginBatchCommand::newSyntax()
+{
+  MSyntax syntax;
+  syntax.enableQuery(false);
+  syntax.enableEdit(false);
+  return syntax;
+}
+
+MStatus FabricCanvasBeginBatchCommand::doIt(const MArgList &args)
+{
+  FabricDFGBaseInterface::beginBatch();
+  return MS::kSuccess;
+}
+
+// FabricCanvasEndBatchCommand
+
+MSyntax FabricCanvasEndBatchCommand::newSyntax()
+{
+  MSyntax syntax;
+  syntax.enableQuery(false);
+  syntax.enableEdit(false);
+  return syntax;
+}
+
+MStatus FabricCanvasEndBatchCommand::doIt(const MArgList &args)
+{
+  if ( !FabricDFGBaseInterface::endBatch() )
+  {
+    logError( "no batch is open, call FabricCanvasBeginBatch first." );
+    return MS::kFailure;
+  }
+  return MS::kSuccess;
+}
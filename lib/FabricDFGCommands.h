@@ -1125,3 +1125,39 @@ private:
   std::string m_oldMetadataValue;
   std::string m_newMetadataValue;
 };
+
+// FabricCanvasBeginBatch / FabricCanvasEndBatch bracket a set of Canvas
+// edits: they run in a single undo chunk and the binding notifications
+// are only applied to the Maya attributes once the batch is closed.
+// batches can be nested, only the outermost pair is effective.
+class FabricCanvasBeginBatchCommand
+  : public FabricDFGBaseCommand
+{
+public:
+
+  static void* creator()
+    { return new FabricCanvasBeginBatchCommand; }
+
+  virtual MString getName()
+    { return "FabricCanvasBeginBatch"; }
+
+  static MSyntax newSyntax();
+  virtual MStatus doIt( const MArgList &args );
+  virtual bool isUndoable() const { return false; }
+};
+
+class FabricCanvasEndBatchCommand
+  : public FabricDFGBaseCommand
+{
+public:
+
+  static void* creator()
+    { return new FabricCanvasEndBatchCommand; }
+
+  virtual MString getName()
+    { return "FabricCanvasEndBatch"; }
+
+  static MSyntax newSyntax();
+  virtual MStatus doIt( const MArgList &args );
+  virtual bool isUndoable() const { return false; }
+};
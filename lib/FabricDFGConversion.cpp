@@ -5,6 +5,8 @@
 #include "FabricDFGConversion.h"
 #include "FabricSpliceMayaData.h"
 #include "FabricSpliceHelpers.h"
+#include "FabricMayaMeshChannel.h"
+#include "FabricMayaKernels.h"
 
 #include <maya/MGlobal.h>
 #include <maya/MFnDependencyNode.h>
@@ -16,6 +18,7 @@
 #include <maya/MFnDoubleArrayData.h>
 #include <maya/MFnVectorArrayData.h>
 #include <maya/MFnPointArrayData.h>
+#include <maya/MFnArrayAttrsData.h>
 #include <maya/MIntArray.h>
 #include <maya/MDoubleArray.h>
 #include <maya/MVectorArray.h>
@@ -33,6 +36,8 @@
 #include <maya/MFnNurbsCurveData.h>
 #include <maya/MFloatVectorArray.h>
 #include <maya/MFnAnimCurve.h>
+#include <maya/MTransformationMatrix.h>
+#include <maya/MQuaternion.h>
 
 #define CORE_CATCH_BEGIN try {
 #define CORE_CATCH_END } \
@@ -52,6 +57,44 @@ struct KLEuler{
   int32_t order;
 };
 
+struct KLVec2{
+  float x;
+  float y;
+};
+
+struct KLVec3{
+  float x;
+  float y;
+  float z;
+};
+
+struct KLVec4{
+  float x;
+  float y;
+  float z;
+  float t;
+};
+
+struct KLQuat{
+  float x;
+  float y;
+  float z;
+  float w;
+};
+
+struct KLColor{
+  float r;
+  float g;
+  float b;
+  float a;
+};
+
+struct KLXfo{
+  KLQuat ori;
+  KLVec3 tr;
+  KLVec3 sc;
+};
+
 typedef float floatVec[3];
 
 double dfgGetFloat64FromRTVal(FabricCore::RTVal rtVal)
@@ -76,6 +119,121 @@ double dfgGetFloat64FromRTVal(FabricCore::RTVal rtVal)
   return DBL_MAX;
 }
 
+// the numeric element types of KL arrays, used to move Maya
+// int and double buffers without going through RTVals
+enum DFGArrayElementKind
+{
+  DFG_ArrayElement_Unknown,
+  DFG_ArrayElement_SInt8,
+  DFG_ArrayElement_UInt8,
+  DFG_ArrayElement_SInt16,
+  DFG_ArrayElement_UInt16,
+  DFG_ArrayElement_SInt32,
+  DFG_ArrayElement_UInt32,
+  DFG_ArrayElement_SInt64,
+  DFG_ArrayElement_UInt64,
+  DFG_ArrayElement_Float32,
+  DFG_ArrayElement_Float64
+};
+
+static DFGArrayElementKind dfgGetArrayElementKind(FabricCore::DFGBinding & binding, char const * argName)
+{
+  char const * resolvedType = binding.getExec().getExecPortResolvedType(argName);
+  if(!resolvedType)
+  {
+    mayaLogErrorFunc(MString("The port '")+argName+"' has no resolved type, it won't be converted.");
+    return DFG_ArrayElement_Unknown;
+  }
+
+  std::string type(resolvedType);
+  if(type.length() > 2 && type.substr(type.length()-2, 2) == "[]")
+    type = type.substr(0, type.length()-2);
+
+  if(type == "SInt8")                                   return DFG_ArrayElement_SInt8;
+  if(type == "UInt8" || type == "Byte")                 return DFG_ArrayElement_UInt8;
+  if(type == "SInt16")                                  return DFG_ArrayElement_SInt16;
+  if(type == "UInt16")                                  return DFG_ArrayElement_UInt16;
+  if(type == "SInt32" || type == "Integer")             return DFG_ArrayElement_SInt32;
+  if(type == "UInt32" || type == "Index" ||
+     type == "Count")                                   return DFG_ArrayElement_UInt32;
+  if(type == "SInt64")                                  return DFG_ArrayElement_SInt64;
+  if(type == "UInt64" || type == "Size" ||
+     type == "DataSize")                                return DFG_ArrayElement_UInt64;
+  if(type == "Float32" || type == "Scalar")             return DFG_ArrayElement_Float32;
+  if(type == "Float64")                                 return DFG_ArrayElement_Float64;
+
+  mayaLogErrorFunc(MString("The elements of port '")+argName+"' ("+resolvedType+") aren't numeric, it won't be converted.");
+  return DFG_ArrayElement_Unknown;
+}
+
+template<typename Ty> struct DFGArrayElementKindOf { enum { value = DFG_ArrayElement_Unknown }; };
+template<> struct DFGArrayElementKindOf<int> { enum { value = DFG_ArrayElement_SInt32 }; };
+template<> struct DFGArrayElementKindOf<double> { enum { value = DFG_ArrayElement_Float64 }; };
+
+template<typename SrcTy, typename DstTy>
+inline void dfgConvertArrayData(const void * src, void * dst, unsigned int count)
+{
+  const SrcTy * srcValues = (const SrcTy *)src;
+  DstTy * dstValues = (DstTy *)dst;
+  for(unsigned int i=0;i<count;i++)
+    dstValues[i] = (DstTy)srcValues[i];
+}
+
+// copies a Maya int or double buffer into the data of a KL array,
+// a plain memcpy if the element types match
+template<typename MayaTy>
+static bool dfgMayaToKLArrayData(DFGArrayElementKind kind, const MayaTy * src, void * dst, unsigned int count)
+{
+  if(count == 0)
+    return true;
+  if(kind == (DFGArrayElementKind)DFGArrayElementKindOf<MayaTy>::value)
+  {
+    memcpy(dst, src, sizeof(MayaTy) * count);
+    return true;
+  }
+  switch(kind)
+  {
+    case DFG_ArrayElement_SInt8:   dfgConvertArrayData<MayaTy, int8_t>(src, dst, count);   return true;
+    case DFG_ArrayElement_UInt8:   dfgConvertArrayData<MayaTy, uint8_t>(src, dst, count);  return true;
+    case DFG_ArrayElement_SInt16:  dfgConvertArrayData<MayaTy, int16_t>(src, dst, count);  return true;
+    case DFG_ArrayElement_UInt16:  dfgConvertArrayData<MayaTy, uint16_t>(src, dst, count); return true;
+    case DFG_ArrayElement_SInt32:  dfgConvertArrayData<MayaTy, int32_t>(src, dst, count);  return true;
+    case DFG_ArrayElement_UInt32:  dfgConvertArrayData<MayaTy, uint32_t>(src, dst, count); return true;
+    case DFG_ArrayElement_SInt64:  dfgConvertArrayData<MayaTy, int64_t>(src, dst, count);  return true;
+    case DFG_ArrayElement_UInt64:  dfgConvertArrayData<MayaTy, uint64_t>(src, dst, count); return true;
+    case DFG_ArrayElement_Float32: dfgConvertArrayData<MayaTy, float>(src, dst, count);    return true;
+    case DFG_ArrayElement_Float64: dfgConvertArrayData<MayaTy, double>(src, dst, count);   return true;
+    default: return false;
+  }
+}
+
+// the other direction, from the data of a KL array into a Maya buffer
+template<typename MayaTy>
+static bool dfgKLToMayaArrayData(DFGArrayElementKind kind, const void * src, MayaTy * dst, unsigned int count)
+{
+  if(count == 0)
+    return true;
+  if(kind == (DFGArrayElementKind)DFGArrayElementKindOf<MayaTy>::value)
+  {
+    memcpy(dst, src, sizeof(MayaTy) * count);
+    return true;
+  }
+  switch(kind)
+  {
+    case DFG_ArrayElement_SInt8:   dfgConvertArrayData<int8_t, MayaTy>(src, dst, count);   return true;
+    case DFG_ArrayElement_UInt8:   dfgConvertArrayData<uint8_t, MayaTy>(src, dst, count);  return true;
+    case DFG_ArrayElement_SInt16:  dfgConvertArrayData<int16_t, MayaTy>(src, dst, count);  return true;
+    case DFG_ArrayElement_UInt16:  dfgConvertArrayData<uint16_t, MayaTy>(src, dst, count); return true;
+    case DFG_ArrayElement_SInt32:  dfgConvertArrayData<int32_t, MayaTy>(src, dst, count);  return true;
+    case DFG_ArrayElement_UInt32:  dfgConvertArrayData<uint32_t, MayaTy>(src, dst, count); return true;
+    case DFG_ArrayElement_SInt64:  dfgConvertArrayData<int64_t, MayaTy>(src, dst, count);  return true;
+    case DFG_ArrayElement_UInt64:  dfgConvertArrayData<uint64_t, MayaTy>(src, dst, count); return true;
+    case DFG_ArrayElement_Float32: dfgConvertArrayData<float, MayaTy>(src, dst, count);    return true;
+    case DFG_ArrayElement_Float64: dfgConvertArrayData<double, MayaTy>(src, dst, count);   return true;
+    default: return false;
+  }
+}
+
 inline void Mat44ToMMatrix_data(float const *data, MMatrix &matrix)
 {
   double vals[4][4] ={
@@ -96,22 +254,7 @@ inline void Mat44ToMMatrix(FabricCore::RTVal &rtVal, MMatrix &matrix)
 
 inline void MMatrixToMat44_data(MMatrix const &matrix, float *data)
 {
-  data[0]  = (float)matrix[0][0];
-  data[1]  = (float)matrix[1][0];
-  data[2]  = (float)matrix[2][0];
-  data[3]  = (float)matrix[3][0];
-  data[4]  = (float)matrix[0][1];
-  data[5]  = (float)matrix[1][1];
-  data[6]  = (float)matrix[2][1];
-  data[7]  = (float)matrix[3][1];
-  data[8]  = (float)matrix[0][2];
-  data[9]  = (float)matrix[1][2];
-  data[10] = (float)matrix[2][2];
-  data[11] = (float)matrix[3][2];
-  data[12] = (float)matrix[0][3];
-  data[13] = (float)matrix[1][3];
-  data[14] = (float)matrix[2][3];
-  data[15] = (float)matrix[3][3];
+  FabricMaya::Kernels::MatricesToMat44(&matrix.matrix[0][0], data, 1);
 }
 
 inline void MMatrixToMat44(MMatrix const &matrix, FabricCore::RTVal &rtVal)
@@ -700,13 +843,31 @@ void dfgPlugToPort_integer(MPlug &plug, MDataBlock &data,
 
     FabricCore::RTVal rtVal = binding.getArgValue(argName);
     rtVal.setArraySize(elements);
-    FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
-    int32_t * values = (int32_t*)dataRtVal.getData();
+    if(elements > 0)
+    {
+      DFGArrayElementKind kind = dfgGetArrayElementKind(binding, argName);
+      if(kind == DFG_ArrayElement_Unknown)
+        return;
 
-    for(unsigned int i = 0; i < elements; ++i){
-      arrayHandle.jumpToArrayElement(i);
-      MDataHandle handle = arrayHandle.inputValue();
-      values[i] = handle.asLong();
+      FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+      if(kind == DFG_ArrayElement_SInt32)
+      {
+        // the elements are written straight into the KL array
+        int32_t * values = (int32_t*)dataRtVal.getData();
+        for(unsigned int i = 0; i < elements; ++i){
+          arrayHandle.jumpToArrayElement(i);
+          values[i] = arrayHandle.inputValue().asLong();
+        }
+      }
+      else
+      {
+        MIntArray arrayValues(elements);
+        for(unsigned int i = 0; i < elements; ++i){
+          arrayHandle.jumpToArrayElement(i);
+          arrayValues[i] = arrayHandle.inputValue().asLong();
+        }
+        dfgMayaToKLArrayData(kind, &arrayValues[0], dataRtVal.getData(), elements);
+      }
     }
 
     binding.setArgValue_lockType(lockType, argName, rtVal, false);
@@ -719,14 +880,13 @@ void dfgPlugToPort_integer(MPlug &plug, MDataBlock &data,
       MIntArray arrayValues = MFnIntArrayData(handle.data()).array();
       unsigned int elements = arrayValues.length();
 
+      // SInt32 arrays are copied as one block, other integer
+      // element types are converted in a single pass
       FabricCore::RTVal rtVal = binding.getArgValue(argName);
       rtVal.setArraySize(elements);
       FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
-      int32_t * values = (int32_t*)dataRtVal.getData();
-
-      for(unsigned int i = 0; i < elements; ++i){
-        values[i] = arrayValues[i];
-      }
+      if(elements > 0 && !dfgMayaToKLArrayData(dfgGetArrayElementKind(binding, argName), &arrayValues[0], dataRtVal.getData(), elements))
+        return;
 
       binding.setArgValue_lockType(lockType, argName, rtVal, false);
     }else{
@@ -737,6 +897,20 @@ void dfgPlugToPort_integer(MPlug &plug, MDataBlock &data,
   }
 }
 
+// the value of a scalar handle in the unit used on the KL side
+static double dfgGetScalarFromHandle(MDataHandle handle, const FTL::CStrRef & scalarUnit)
+{
+  if(scalarUnit == "time")
+    return handle.asTime().as(MTime::kSeconds);
+  if(scalarUnit == "angle")
+    return handle.asAngle().as(MAngle::kRadians);
+  if(scalarUnit == "distance")
+    return handle.asDistance().as(MDistance::kMillimeters);
+  if(handle.numericType() == MFnNumericData::kFloat)
+    return handle.asFloat();
+  return handle.asDouble();
+}
+
 void dfgPlugToPort_scalar(MPlug &plug, MDataBlock &data, 
     FabricCore::DFGBinding & binding,
     FabricCore::LockType lockType,
@@ -754,26 +928,30 @@ void dfgPlugToPort_scalar(MPlug &plug, MDataBlock &data,
 
     FabricCore::RTVal rtVal = binding.getArgValue(argName);
     rtVal.setArraySize(elements);
-    FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
-    float * values = (float*)dataRtVal.getData();
-
-    for(unsigned int i = 0; i < elements; ++i){
-      arrayHandle.jumpToArrayElement(i);
-      MDataHandle handle = arrayHandle.inputValue();
+    if(elements > 0)
+    {
+      DFGArrayElementKind kind = dfgGetArrayElementKind(binding, argName);
+      if(kind == DFG_ArrayElement_Unknown)
+        return;
 
-      if(scalarUnit == "time")
-        values[i] = handle.asTime().as(MTime::kSeconds);
-      else if(scalarUnit == "angle")
-        values[i] = handle.asAngle().as(MAngle::kRadians);
-      else if(scalarUnit == "distance")
-        values[i] = handle.asDistance().as(MDistance::kMillimeters);
+      FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+      if(kind == DFG_ArrayElement_Float32)
+      {
+        // the elements are written straight into the KL array
+        float * values = (float*)dataRtVal.getData();
+        for(unsigned int i = 0; i < elements; ++i){
+          arrayHandle.jumpToArrayElement(i);
+          values[i] = (float)dfgGetScalarFromHandle(arrayHandle.inputValue(), scalarUnit);
+        }
+      }
       else
       {
-        if(handle.numericType() == MFnNumericData::kFloat){
-          values[i] = handle.asFloat();
-        }else{
-          values[i] = handle.asDouble();
+        MDoubleArray values(elements);
+        for(unsigned int i = 0; i < elements; ++i){
+          arrayHandle.jumpToArrayElement(i);
+          values[i] = dfgGetScalarFromHandle(arrayHandle.inputValue(), scalarUnit);
         }
+        dfgMayaToKLArrayData(kind, &values[0], dataRtVal.getData(), elements);
       }
     }
 
@@ -786,14 +964,13 @@ void dfgPlugToPort_scalar(MPlug &plug, MDataBlock &data,
     if(rtVal.isArray()){
       MDoubleArray arrayValues = MFnDoubleArrayData(handle.data()).array();
       unsigned int elements = arrayValues.length();
-  
+
+      // Float64 arrays are copied as one block, Float32
+      // arrays are narrowed in a single pass
       rtVal.setArraySize(elements);
       FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
-      float * values = (float*)dataRtVal.getData();
-
-      for(unsigned int i = 0; i < elements; ++i){
-        values[i] = arrayValues[i];
-      }
+      if(elements > 0 && !dfgMayaToKLArrayData(dfgGetArrayElementKind(binding, argName), &arrayValues[0], dataRtVal.getData(), elements))
+        return;
 
       binding.setArgValue_lockType(lockType, argName, rtVal, false);
     }
@@ -874,7 +1051,216 @@ void dfgPlugToPort_string(MPlug &plug, MDataBlock &data,
   CORE_CATCH_END;
 }
 
-void dfgPlugToPort_color(MPlug &plug, MDataBlock &data, 
+// The POD struct types below are converted through the memory layout
+// of their KL structs: whole arrays are read and written through the
+// array's data() pointer, single values through a one element array.
+// The members which aren't set from Maya keep the values of a default
+// constructed element, as the Euler's rotation order.
+typedef void(*DFGPODHandleToDataFunc)(MDataHandle &handle, void *element);
+typedef void(*DFGPODDataToHandleFunc)(void const *element, MDataHandle &handle);
+
+struct DFGPODStructLayout
+{
+  char const * typeName;
+  size_t elementSize;
+  DFGPODHandleToDataFunc handleToData;
+  DFGPODDataToHandleFunc dataToHandle;
+
+  // set up by dfgCheckPODStructLayout, -1 if the KL struct doesn't match
+  int checked;
+  std::vector<char> defaultElement;
+
+  DFGPODStructLayout(
+    char const * typeName_,
+    size_t elementSize_,
+    DFGPODHandleToDataFunc handleToData_,
+    DFGPODDataToHandleFunc dataToHandle_
+    )
+    : typeName(typeName_)
+    , elementSize(elementSize_)
+    , handleToData(handleToData_)
+    , dataToHandle(dataToHandle_)
+    , checked(0)
+  {}
+};
+
+void dfgPODHandleToVec2(MDataHandle &handle, void *element)
+{
+  KLVec2 * v = (KLVec2 *)element;
+  if(handle.numericType() == MFnNumericData::k2Float){
+    const float2& mayaVec = handle.asFloat2();
+    v->x = mayaVec[0];
+    v->y = mayaVec[1];
+  } else {
+    const double2& mayaVec = handle.asDouble2();
+    v->x = (float)mayaVec[0];
+    v->y = (float)mayaVec[1];
+  }
+}
+
+void dfgPODVec2ToHandle(void const *element, MDataHandle &handle)
+{
+  KLVec2 const * v = (KLVec2 const *)element;
+  if(handle.numericType() == MFnNumericData::k2Float)
+    handle.set2Float(v->x, v->y);
+  else
+    handle.set2Double(v->x, v->y);
+}
+
+void dfgPODHandleToVec4(MDataHandle &handle, void *element)
+{
+  KLVec4 * v = (KLVec4 *)element;
+  const double4& mayaVec = handle.asDouble4();
+  v->x = (float)mayaVec[0];
+  v->y = (float)mayaVec[1];
+  v->z = (float)mayaVec[2];
+  v->t = (float)mayaVec[3];
+}
+
+void dfgPODVec4ToHandle(void const *element, MDataHandle &handle)
+{
+  KLVec4 const * v = (KLVec4 const *)element;
+  handle.set4Double(v->x, v->y, v->z, v->t);
+}
+
+void dfgPODHandleToQuat(MDataHandle &handle, void *element)
+{
+  KLQuat * q = (KLQuat *)element;
+  const double4& mayaQuat = handle.asDouble4();
+  q->x = (float)mayaQuat[0];
+  q->y = (float)mayaQuat[1];
+  q->z = (float)mayaQuat[2];
+  q->w = (float)mayaQuat[3];
+}
+
+void dfgPODQuatToHandle(void const *element, MDataHandle &handle)
+{
+  KLQuat const * q = (KLQuat const *)element;
+  handle.set4Double(q->x, q->y, q->z, q->w);
+}
+
+void dfgPODHandleToColor(MDataHandle &handle, void *element)
+{
+  KLColor * c = (KLColor *)element;
+  if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat){
+    MFloatVector v = handle.asFloatVector();
+    c->r = v.x;
+    c->g = v.y;
+    c->b = v.z;
+  } else {
+    MVector v = handle.asVector();
+    c->r = (float)v.x;
+    c->g = (float)v.y;
+    c->b = (float)v.z;
+  }
+  c->a = 1.0f;
+}
+
+void dfgPODColorToHandle(void const *element, MDataHandle &handle)
+{
+  KLColor const * c = (KLColor const *)element;
+  if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat)
+    handle.setMFloatVector(MFloatVector(c->r, c->g, c->b));
+  else
+    handle.setMVector(MVector(c->r, c->g, c->b));
+}
+
+void dfgPODHandleToEuler(MDataHandle &handle, void *element)
+{
+  KLEuler * e = (KLEuler *)element;
+  if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat){
+    const float3& mayaVec = handle.asFloat3();
+    e->x = mayaVec[0];
+    e->y = mayaVec[1];
+    e->z = mayaVec[2];
+  } else {
+    const double3& mayaVec = handle.asDouble3();
+    e->x = (float)mayaVec[0];
+    e->y = (float)mayaVec[1];
+    e->z = (float)mayaVec[2];
+  }
+}
+
+void dfgPODEulerToHandle(void const *element, MDataHandle &handle)
+{
+  KLEuler const * e = (KLEuler const *)element;
+  if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat)
+    handle.set3Float(e->x, e->y, e->z);
+  else
+    handle.set3Double(e->x, e->y, e->z);
+}
+
+void dfgPODHandleToXfo(MDataHandle &handle, void *element)
+{
+  KLXfo * xfo = (KLXfo *)element;
+  MTransformationMatrix transform(handle.asMatrix());
+
+  double qx, qy, qz, qw;
+  transform.getRotationQuaternion(qx, qy, qz, qw);
+  xfo->ori.x = (float)qx;
+  xfo->ori.y = (float)qy;
+  xfo->ori.z = (float)qz;
+  xfo->ori.w = (float)qw;
+
+  MVector tr = transform.getTranslation(MSpace::kTransform);
+  xfo->tr.x = (float)tr.x;
+  xfo->tr.y = (float)tr.y;
+  xfo->tr.z = (float)tr.z;
+
+  double sc[3];
+  transform.getScale(sc, MSpace::kTransform);
+  xfo->sc.x = (float)sc[0];
+  xfo->sc.y = (float)sc[1];
+  xfo->sc.z = (float)sc[2];
+}
+
+void dfgPODXfoToHandle(void const *element, MDataHandle &handle)
+{
+  KLXfo const * xfo = (KLXfo const *)element;
+  MTransformationMatrix transform;
+
+  double sc[3] = { xfo->sc.x, xfo->sc.y, xfo->sc.z };
+  transform.setScale(sc, MSpace::kTransform);
+  transform.setRotationQuaternion(xfo->ori.x, xfo->ori.y, xfo->ori.z, xfo->ori.w);
+  transform.setTranslation(MVector(xfo->tr.x, xfo->tr.y, xfo->tr.z), MSpace::kTransform);
+
+  handle.setMMatrix(transform.asMatrix());
+}
+
+static DFGPODStructLayout s_podLayoutVec2("Vec2", sizeof(KLVec2), dfgPODHandleToVec2, dfgPODVec2ToHandle);
+static DFGPODStructLayout s_podLayoutVec4("Vec4", sizeof(KLVec4), dfgPODHandleToVec4, dfgPODVec4ToHandle);
+static DFGPODStructLayout s_podLayoutQuat("Quat", sizeof(KLQuat), dfgPODHandleToQuat, dfgPODQuatToHandle);
+static DFGPODStructLayout s_podLayoutColor("Color", sizeof(KLColor), dfgPODHandleToColor, dfgPODColorToHandle);
+static DFGPODStructLayout s_podLayoutEuler("Euler", sizeof(KLEuler), dfgPODHandleToEuler, dfgPODEulerToHandle);
+static DFGPODStructLayout s_podLayoutXfo("Xfo", sizeof(KLXfo), dfgPODHandleToXfo, dfgPODXfoToHandle);
+
+bool dfgCheckPODStructLayout(DFGPODStructLayout & layout)
+{
+  if(layout.checked == 0)
+  {
+    layout.checked = -1;
+
+    FabricCore::RTVal arrayVal = FabricSplice::constructVariableArrayRTVal(layout.typeName);
+    arrayVal.setArraySize(1);
+    arrayVal.setArrayElement(0, FabricSplice::constructRTVal(layout.typeName));
+
+    size_t dataSize = (size_t)dfgGetFloat64FromRTVal(arrayVal.callMethod("DataSize", "dataSize", 0, 0));
+    if(dataSize != layout.elementSize)
+    {
+      mayaLogErrorFunc(MString("The memory layout of the KL type '")+layout.typeName+"' doesn't match, it won't be converted.");
+      return false;
+    }
+
+    FabricCore::RTVal dataRtVal = arrayVal.callMethod("Data", "data", 0, 0);
+    layout.defaultElement.resize(layout.elementSize);
+    memcpy(&layout.defaultElement[0], dataRtVal.getData(), layout.elementSize);
+    layout.checked = 1;
+  }
+  return layout.checked > 0;
+}
+
+void dfgPlugToPort_podStruct(DFGPODStructLayout & layout,
+    MPlug &plug, MDataBlock &data, 
     FabricCore::DFGBinding & binding,
     FabricCore::LockType lockType,
     char const * argName,
@@ -882,35 +1268,34 @@ void dfgPlugToPort_color(MPlug &plug, MDataBlock &data,
 {
   CORE_CATCH_BEGIN;
 
+  if(!dfgCheckPODStructLayout(layout))
+    return;
+
   if(plug.isArray()){
     timers->stop();
     MArrayDataHandle arrayHandle = data.inputArrayValue(plug);
     timers->resume();
+
     unsigned int elements = arrayHandle.elementCount();
-    FabricCore::RTVal arrayVal = FabricSplice::constructVariableArrayRTVal("Color");
-    FabricCore::RTVal color = FabricSplice::constructRTVal("Color");
-    FabricCore::RTVal arraySizeVal = FabricSplice::constructUInt32RTVal(elements);
-    arrayVal.callMethod("", "resize", 1, &arraySizeVal);
-    for(unsigned int i = 0; i < elements; ++i){
-      arrayHandle.jumpToArrayElement(i);
-      MDataHandle handle = arrayHandle.inputValue();
 
-      if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat){
-        MFloatVector v = handle.asFloatVector();
-        color.setMember("r", FabricSplice::constructFloat64RTVal(v.x));
-        color.setMember("g", FabricSplice::constructFloat64RTVal(v.y));
-        color.setMember("b", FabricSplice::constructFloat64RTVal(v.z));
-      } else{
-        MVector v = handle.asVector();
-        color.setMember("r", FabricSplice::constructFloat64RTVal(v.x));
-        color.setMember("g", FabricSplice::constructFloat64RTVal(v.y));
-        color.setMember("b", FabricSplice::constructFloat64RTVal(v.z));
+    FabricCore::RTVal rtVal = binding.getArgValue(argName);
+    if(!rtVal.isArray())
+      return;
+    rtVal.setArraySize(elements);
+    if(elements > 0)
+    {
+      FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+      char * values = (char*)dataRtVal.getData();
+      for(unsigned int i = 0; i < elements; ++i){
+        arrayHandle.jumpToArrayElement(i);
+        MDataHandle handle = arrayHandle.inputValue();
+        char * element = values + i * layout.elementSize;
+        memcpy(element, &layout.defaultElement[0], layout.elementSize);
+        layout.handleToData(handle, element);
       }
-      color.setMember("a", FabricSplice::constructFloat64RTVal(1.0));
-      arrayVal.setArrayElement(i, color);
     }
 
-    binding.setArgValue_lockType(lockType, argName, arrayVal, false);
+    binding.setArgValue_lockType(lockType, argName, rtVal, false);
   }
   else {
     FabricCore::RTVal rtVal = binding.getArgValue(argName);
@@ -920,26 +1305,70 @@ void dfgPlugToPort_color(MPlug &plug, MDataBlock &data,
     MDataHandle handle = data.inputValue(plug);
     timers->resume();
 
-    FabricCore::RTVal color = FabricSplice::constructRTVal("Color");
-    if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat){
-      MFloatVector v = handle.asFloatVector();
-      color.setMember("r", FabricSplice::constructFloat64RTVal(v.x));
-      color.setMember("g", FabricSplice::constructFloat64RTVal(v.y));
-      color.setMember("b", FabricSplice::constructFloat64RTVal(v.z));
-    } else{
-      MVector v = handle.asVector();
-      color.setMember("r", FabricSplice::constructFloat64RTVal(v.x));
-      color.setMember("g", FabricSplice::constructFloat64RTVal(v.y));
-      color.setMember("b", FabricSplice::constructFloat64RTVal(v.z));
+    FabricCore::RTVal arrayVal = FabricSplice::constructVariableArrayRTVal(layout.typeName);
+    arrayVal.setArraySize(1);
+    FabricCore::RTVal dataRtVal = arrayVal.callMethod("Data", "data", 0, 0);
+    char * element = (char*)dataRtVal.getData();
+    memcpy(element, &layout.defaultElement[0], layout.elementSize);
+    layout.handleToData(handle, element);
+
+    binding.setArgValue_lockType(lockType, argName, arrayVal.getArrayElement(0), false);
+  }
+
+  CORE_CATCH_END;
+}
+
+void dfgPortToPlug_podStruct(DFGPODStructLayout & layout,
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName, MPlug &plug, MDataBlock &data)
+{
+  CORE_CATCH_BEGIN;
+
+  if(!dfgCheckPODStructLayout(layout))
+    return;
+
+  if(plug.isArray()){
+    MArrayDataHandle arrayHandle = data.outputArrayValue(plug);
+    MArrayDataBuilder arraybuilder = arrayHandle.builder();
+
+    FabricCore::RTVal rtVal = binding.getArgValue(argName);
+    unsigned int elements = rtVal.getArraySize();
+    if(elements > 0)
+    {
+      FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+      char const * values = (char const *)dataRtVal.getData();
+      for(unsigned int i = 0; i < elements; ++i){
+        MDataHandle handle = arraybuilder.addElement(i);
+        layout.dataToHandle(values + i * layout.elementSize, handle);
+      }
     }
-    color.setMember("a", FabricSplice::constructFloat64RTVal(1.0));
 
-    binding.setArgValue_lockType(lockType, argName, color, false);
+    arrayHandle.set(arraybuilder);
+    arrayHandle.setAllClean();
+  }
+  else{
+    MDataHandle handle = data.outputValue(plug);
+
+    FabricCore::RTVal arrayVal = FabricSplice::constructVariableArrayRTVal(layout.typeName);
+    arrayVal.setArraySize(1);
+    arrayVal.setArrayElement(0, binding.getArgValue(argName));
+    FabricCore::RTVal dataRtVal = arrayVal.callMethod("Data", "data", 0, 0);
+    layout.dataToHandle(dataRtVal.getData(), handle);
   }
 
   CORE_CATCH_END;
 }
 
+void dfgPlugToPort_color(MPlug &plug, MDataBlock &data, 
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName,
+    DFGConversionTimers * timers)
+{
+  dfgPlugToPort_podStruct(s_podLayoutColor, plug, data, binding, lockType, argName, timers);
+}
+
 void dfgPlugToPort_vec3(MPlug &plug, MDataBlock &data, 
     FabricCore::DFGBinding & binding,
     FabricCore::LockType lockType,
@@ -1042,84 +1471,64 @@ void dfgPlugToPort_euler(MPlug &plug, MDataBlock &data,
     char const * argName,
     DFGConversionTimers * timers)
 {
-  CORE_CATCH_BEGIN;
+  dfgPlugToPort_podStruct(s_podLayoutEuler, plug, data, binding, lockType, argName, timers);
+}
+
+void dfgPlugToPort_vec2(MPlug &plug, MDataBlock &data, 
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName,
+    DFGConversionTimers * timers)
+{
+  dfgPlugToPort_podStruct(s_podLayoutVec2, plug, data, binding, lockType, argName, timers);
+}
+
+void dfgPlugToPort_vec4(MPlug &plug, MDataBlock &data, 
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName,
+    DFGConversionTimers * timers)
+{
+  dfgPlugToPort_podStruct(s_podLayoutVec4, plug, data, binding, lockType, argName, timers);
+}
+
+void dfgPlugToPort_quat(MPlug &plug, MDataBlock &data, 
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName,
+    DFGConversionTimers * timers)
+{
+  dfgPlugToPort_podStruct(s_podLayoutQuat, plug, data, binding, lockType, argName, timers);
+}
+
+void dfgPlugToPort_xfo(MPlug &plug, MDataBlock &data, 
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName,
+    DFGConversionTimers * timers)
+{
+  dfgPlugToPort_podStruct(s_podLayoutXfo, plug, data, binding, lockType, argName, timers);
+}
 
+void dfgPlugToPort_mat44(MPlug &plug, MDataBlock &data, 
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName,
+    DFGConversionTimers * timers)
+{
   if(plug.isArray()){
     timers->stop();
     MArrayDataHandle arrayHandle = data.inputArrayValue(plug);
     timers->resume();
 
     unsigned int elements = arrayHandle.elementCount();
-    FabricCore::RTVal arrayVal = FabricSplice::constructVariableArrayRTVal("Euler");
-    FabricCore::RTVal euler = FabricSplice::constructRTVal("Euler");
-    FabricCore::RTVal arraySizeVal = FabricSplice::constructUInt32RTVal(elements);
-    arrayVal.callMethod("", "resize", 1, &arraySizeVal);
-    for(unsigned int i = 0; i < elements; ++i){
-      arrayHandle.jumpToArrayElement(i);
-      MDataHandle handle = arrayHandle.inputValue();
-
-      if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat){
-        const float3& mayaVec = handle.asFloat3();
-        euler.setMember("x", FabricSplice::constructFloat64RTVal(mayaVec[0]));
-        euler.setMember("y", FabricSplice::constructFloat64RTVal(mayaVec[1]));
-        euler.setMember("z", FabricSplice::constructFloat64RTVal(mayaVec[2]));
-      } else{
-        const double3& mayaVec = handle.asDouble3();
-        euler.setMember("x", FabricSplice::constructFloat64RTVal(mayaVec[0]));
-        euler.setMember("y", FabricSplice::constructFloat64RTVal(mayaVec[1]));
-        euler.setMember("z", FabricSplice::constructFloat64RTVal(mayaVec[2]));
-      }
-      arrayVal.setArrayElement(i, euler);
-    }
-
-    binding.setArgValue_lockType(lockType, argName, arrayVal, false);
-  }
-  else {
-    FabricCore::RTVal rtVal = binding.getArgValue(argName);
-    if(rtVal.isArray())
-      return;
-    timers->stop();
-    MDataHandle handle = data.inputValue(plug);
-    timers->resume();
-
-    FabricCore::RTVal euler = FabricSplice::constructRTVal("Euler");
-    if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat){
-      const float3& mayaVec = handle.asFloat3();
-      euler.setMember("x", FabricSplice::constructFloat64RTVal(mayaVec[0]));
-      euler.setMember("y", FabricSplice::constructFloat64RTVal(mayaVec[1]));
-      euler.setMember("z", FabricSplice::constructFloat64RTVal(mayaVec[2]));
-    } else{
-      const double3& mayaVec = handle.asDouble3();
-      euler.setMember("x", FabricSplice::constructFloat64RTVal(mayaVec[0]));
-      euler.setMember("y", FabricSplice::constructFloat64RTVal(mayaVec[1]));
-      euler.setMember("z", FabricSplice::constructFloat64RTVal(mayaVec[2]));
-    }
-
-    binding.setArgValue_lockType(lockType, argName, euler, false);
-  }
-
-  CORE_CATCH_END;
-}
-
-void dfgPlugToPort_mat44(MPlug &plug, MDataBlock &data, 
-    FabricCore::DFGBinding & binding,
-    FabricCore::LockType lockType,
-    char const * argName,
-    DFGConversionTimers * timers)
-{
-  if(plug.isArray()){
-    timers->stop();
-    MArrayDataHandle arrayHandle = data.inputArrayValue(plug);
-    timers->resume();
-
-    unsigned int elements = arrayHandle.elementCount();
-
-    FabricCore::RTVal rtVal = binding.getArgValue(argName);
-    rtVal.setArraySize(elements);
-    FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
-    float * values = (float*)dataRtVal.getData();
-
-    unsigned int offset = 0;
+
+    FabricCore::RTVal rtVal = binding.getArgValue(argName);
+    rtVal.setArraySize(elements);
+    FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+    float * values = (float*)dataRtVal.getData();
+
+    unsigned int offset = 0;
     for(unsigned int i = 0; i < elements; ++i){
       arrayHandle.jumpToArrayElement(i);
       MDataHandle handle = arrayHandle.inputValue();
@@ -1151,11 +1560,14 @@ void dfgPlugToPort_PolygonMesh(MPlug &plug, MDataBlock &data,
 {
 
   std::vector<MDataHandle> handles;
+  std::vector<MPlug> plugs;
   std::vector<FabricCore::RTVal> rtVals;
   FabricCore::RTVal portRTVal;
 
   try
   {
+    bool isIO = binding.getExec().getExecPortType(argName) == FabricCore::DFGPortType_IO;
+
     if(plug.isArray())
     {
       portRTVal = binding.getArgValue(argName);
@@ -1168,6 +1580,7 @@ void dfgPlugToPort_PolygonMesh(MPlug &plug, MDataBlock &data,
       for(unsigned int i = 0; i < elements; ++i){
         arrayHandle.jumpToArrayElement(i);
         handles.push_back(arrayHandle.inputValue());
+        plugs.push_back(plug.elementByLogicalIndex(arrayHandle.elementIndex()));
 
         FabricCore::RTVal polygonMesh;
         if(portRTVal.isArray())
@@ -1200,9 +1613,10 @@ void dfgPlugToPort_PolygonMesh(MPlug &plug, MDataBlock &data,
     {
       timers->stop();
       handles.push_back(data.inputValue(plug));
+      plugs.push_back(plug);
       timers->resume();
 
-      if(binding.getExec().getExecPortType(argName) == FabricCore::DFGPortType_IO)
+      if(isIO)
         portRTVal = binding.getArgValue(argName);
       if(!portRTVal.isValid() || portRTVal.isNullObject())
         portRTVal = FabricSplice::constructObjectRTVal("PolygonMesh");
@@ -1211,6 +1625,20 @@ void dfgPlugToPort_PolygonMesh(MPlug &plug, MDataBlock &data,
 
     for(size_t handleIndex=0;handleIndex<handles.size();handleIndex++) 
     {
+      // meshes published by another Canvas node are used as they are,
+      // IO ports get a copy since they modify the mesh in place
+      FabricCore::RTVal sharedMesh;
+      if(FabricMayaMeshChannel::fetch(plugs[handleIndex], handles[handleIndex], sharedMesh))
+      {
+        if(isIO)
+          sharedMesh = sharedMesh.callMethod("PolygonMesh", "clone", 0, 0);
+        if(portRTVal.isArray())
+          portRTVal.setArrayElement(handleIndex, sharedMesh);
+        else
+          portRTVal = sharedMesh;
+        continue;
+      }
+
       MObject meshObj = handles[handleIndex].asMesh();
       MFnMesh mesh(meshObj);
       FabricCore::RTVal polygonMesh = rtVals[handleIndex];
@@ -1267,9 +1695,7 @@ void dfgPlugToPort_PolygonMesh(MPlug &plug, MDataBlock &data,
         MFloatVectorArray values;
         values.setLength(mayaNormalsIds.length());
 
-        unsigned int offset = 0;
-        for(unsigned int i=0;i<mayaNormalsIds.length();i++)
-          values[offset++] = mayaNormals[mayaNormalsIds[i]];
+        FabricMaya::Kernels::GatherVec3(&mayaNormals[0].x, &mayaNormalsIds[0], mayaNormalsIds.length(), &values[0].x);
 
         std::vector<FabricCore::RTVal> args(1);
         args[0] = FabricSplice::constructExternalArrayRTVal("Float32", values.length() * 3, &values[0]);
@@ -1281,7 +1707,6 @@ void dfgPlugToPort_PolygonMesh(MPlug &plug, MDataBlock &data,
       {
         MFloatArray u, v, values;
         mesh.getUVs(u, v);
-        unsigned int offset = 0;
 
         MIntArray counts, indices;
         mesh.getAssignedUVs(counts, indices);
@@ -1289,11 +1714,7 @@ void dfgPlugToPort_PolygonMesh(MPlug &plug, MDataBlock &data,
         values.setLength(indices.length() * 2);
         if(values.length() > 0)
         {
-          for(unsigned int i=0;i<indices.length(); i++)
-          {
-            values[offset++] = u[indices[i]];
-            values[offset++] = v[indices[i]];
-          }
+          FabricMaya::Kernels::GatherUVs(&u[0], &v[0], &indices[0], indices.length(), &values[0]);
           u.clear();
           v.clear();
 
@@ -1407,40 +1828,209 @@ void dfgPlugToPort_Lines(MPlug &plug, MDataBlock &data,
 
       MPointArray mayaPoints;
       curve.getCVs(mayaPoints);
-      std::vector<double> mayaDoubles(mayaPoints.length() * 3);
+      if(mayaPoints.length() == 0)
+        continue;
 
-      size_t nbSegments = (mayaPoints.length() - 1);
-      if(curve.form() == MFnNurbsCurve::kClosed)
-        nbSegments++;
+      std::vector<double> mayaDoubles(mayaPoints.length() * 3);
+      FabricMaya::Kernels::PackPoints(&mayaPoints[0].x, mayaPoints.length(), &mayaDoubles[0]);
 
+      bool closed = curve.form() == MFnNurbsCurve::kClosed;
+      size_t nbSegments = FabricMaya::Kernels::PolylineSegmentCount(mayaPoints.length(), closed);
       std::vector<uint32_t> mayaIndices(nbSegments * 2);
+      if(nbSegments > 0)
+        FabricMaya::Kernels::BuildPolylineSegments(mayaPoints.length(), closed, &mayaIndices[0]);
 
-      size_t voffset = 0;
-      size_t coffset = 0;
-      for(unsigned int i=0;i<mayaPoints.length();i++)
-      {
-        mayaDoubles[voffset++] = mayaPoints[i].x;
-        mayaDoubles[voffset++] = mayaPoints[i].y;
-        mayaDoubles[voffset++] = mayaPoints[i].z;
-        if(i < mayaPoints.length() - 1)
+      FabricCore::RTVal mayaDoublesVal = FabricSplice::constructExternalArrayRTVal("Float64", mayaDoubles.size(), &mayaDoubles[0]);
+      rtVal.callMethod("", "_setPositionsFromExternalArray_d", 1, &mayaDoublesVal);
+
+      FabricCore::RTVal mayaIndicesVal = FabricSplice::constructExternalArrayRTVal("UInt32", mayaIndices.size(), &mayaIndices[0]);
+      rtVal.callMethod("", "_setTopologyFromExternalArray", 1, &mayaIndicesVal);
+    }
+
+    binding.setArgValue_lockType(lockType, argName, portRTVal, false);
+  }
+  catch(FabricCore::Exception e)
+  {
+    mayaLogErrorFunc(e.getDesc_cstr());
+    return;
+  }
+  catch(FabricSplice::Exception e)
+  {
+    mayaLogErrorFunc(e.what());
+    return;
+  }
+}
+
+// the per particle channels of Maya map to the attributes of the
+// Points, "position" is stored in the positions attribute
+static MString dfgPointsAttributeName(const MString & channelName)
+{
+  if(channelName == "position")
+    return "positions";
+  return channelName;
+}
+
+static MString dfgPointsChannelName(const MString & attributeName)
+{
+  if(attributeName == "positions")
+    return "position";
+  return attributeName;
+}
+
+void dfgPlugToPort_Points_singlePoints(MDataHandle handle, FabricCore::RTVal points)
+{
+  CORE_CATCH_BEGIN;
+
+  MStatus status;
+  MFnArrayAttrsData arrayAttrs(handle.data(), &status);
+  if(status != MS::kSuccess)
+  {
+    FabricCore::RTVal countVal = FabricSplice::constructUInt64RTVal(0);
+    points.callMethod("", "resize", 1, &countVal);
+    return;
+  }
+
+  MStringArray channels = arrayAttrs.list();
+
+  // the number of particles is taken from the position channel,
+  // channels of a different length are skipped
+  unsigned int count = arrayAttrs.count();
+  MFnArrayAttrsData::Type channelType;
+  if(arrayAttrs.checkArrayExist("position", channelType) && channelType == MFnArrayAttrsData::kVectorArray)
+    count = arrayAttrs.vectorArray("position").length();
+
+  FabricCore::RTVal countVal = FabricSplice::constructUInt64RTVal(count);
+  points.callMethod("", "resize", 1, &countVal);
+  FabricCore::RTVal attributes = points.maybeGetMember("attributes");
+
+  for(unsigned int i=0;i<channels.length();i++)
+  {
+    if(!arrayAttrs.checkArrayExist(channels[i], channelType))
+      continue;
+
+    FabricCore::RTVal nameVal = FabricSplice::constructStringRTVal(dfgPointsAttributeName(channels[i]).asChar());
+    FabricCore::RTVal attribute;
+
+    if(channelType == MFnArrayAttrsData::kVectorArray)
+    {
+      MVectorArray values = arrayAttrs.vectorArray(channels[i]);
+      if(values.length() != count)
+        continue;
+
+      FabricCore::RTVal rtVal = FabricSplice::constructVariableArrayRTVal("Vec3");
+      rtVal.setArraySize(count);
+      FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+      float * dst = (float*)dataRtVal.getData();
+      const double * src = count > 0 ? &values[0].x : NULL;
+      for(unsigned int j=0;j<count*3;j++)
+        dst[j] = (float)src[j];
+
+      attribute = attributes.callMethod("Vec3Attribute", "getOrCreateVec3Attribute", 1, &nameVal);
+      attribute.setMember("values", rtVal);
+    }
+    else if(channelType == MFnArrayAttrsData::kDoubleArray)
+    {
+      MDoubleArray values = arrayAttrs.doubleArray(channels[i]);
+      if(values.length() != count)
+        continue;
+
+      FabricCore::RTVal rtVal = FabricSplice::constructVariableArrayRTVal("Float32");
+      rtVal.setArraySize(count);
+      FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+      float * dst = (float*)dataRtVal.getData();
+      const double * src = count > 0 ? &values[0] : NULL;
+      for(unsigned int j=0;j<count;j++)
+        dst[j] = (float)src[j];
+
+      attribute = attributes.callMethod("ScalarAttribute", "getOrCreateScalarAttribute", 1, &nameVal);
+      attribute.setMember("values", rtVal);
+    }
+    else if(channelType == MFnArrayAttrsData::kIntArray)
+    {
+      MIntArray values = arrayAttrs.intArray(channels[i]);
+      if(values.length() != count)
+        continue;
+
+      FabricCore::RTVal rtVal = FabricSplice::constructVariableArrayRTVal("SInt32");
+      rtVal.setArraySize(count);
+      FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+      if(count > 0)
+        memcpy(dataRtVal.getData(), &values[0], sizeof(int32_t) * count);
+
+      attribute = attributes.callMethod("IntegerAttribute", "getOrCreateIntegerAttribute", 1, &nameVal);
+      attribute.setMember("values", rtVal);
+    }
+    else
+    {
+      // string channels aren't supported
+      continue;
+    }
+
+    attribute.callMethod("", "incrementVersion", 0, 0);
+  }
+
+  CORE_CATCH_END;
+}
+
+void dfgPlugToPort_Points(MPlug &plug, MDataBlock &data, 
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName,
+    DFGConversionTimers * timers)
+{
+
+  std::vector<MDataHandle> handles;
+  std::vector<FabricCore::RTVal> rtVals;
+  FabricCore::RTVal portRTVal;
+
+  try
+  {
+    if(plug.isArray())
+    {
+      portRTVal = binding.getArgValue(argName);
+
+      timers->stop();
+      MArrayDataHandle arrayHandle = data.inputArrayValue(plug);
+      timers->resume();
+
+      unsigned int elements = arrayHandle.elementCount();
+      for(unsigned int i = 0; i < elements; ++i){
+        arrayHandle.jumpToArrayElement(i);
+        handles.push_back(arrayHandle.inputValue());
+
+        FabricCore::RTVal rtVal;
+        if(portRTVal.getArraySize() <= i)
         {
-          mayaIndices[coffset++] = i;
-          mayaIndices[coffset++] = i + 1;
+          rtVal = FabricSplice::constructObjectRTVal("Points");
+          portRTVal.callMethod("", "push", 1, &rtVal);
         }
-        else if(curve.form() == MFnNurbsCurve::kClosed)
+        else
         {
-          mayaIndices[coffset++] = i;
-          mayaIndices[coffset++] = 0;
+          rtVal = portRTVal.getArrayElement(i);
+          if(!rtVal.isValid() || rtVal.isNullObject())
+          {
+            rtVal = FabricSplice::constructObjectRTVal("Points");
+            portRTVal.setArrayElement(i, rtVal);
+          }
         }
+        rtVals.push_back(rtVal);
       }
+    }
+    else
+    {
+      timers->stop();
+      handles.push_back(data.inputValue(plug));
+      timers->resume();
 
-      FabricCore::RTVal mayaDoublesVal = FabricSplice::constructExternalArrayRTVal("Float64", mayaDoubles.size(), &mayaDoubles[0]);
-      rtVal.callMethod("", "_setPositionsFromExternalArray_d", 1, &mayaDoublesVal);
-
-      FabricCore::RTVal mayaIndicesVal = FabricSplice::constructExternalArrayRTVal("UInt32", mayaIndices.size(), &mayaIndices[0]);
-      rtVal.callMethod("", "_setTopologyFromExternalArray", 1, &mayaIndicesVal);
+      portRTVal = binding.getArgValue(argName);
+      if(!portRTVal.isValid() || portRTVal.isNullObject())
+        portRTVal = FabricSplice::constructObjectRTVal("Points");
+      rtVals.push_back(portRTVal);
     }
 
+    for(size_t handleIndex=0;handleIndex<handles.size();handleIndex++) 
+      dfgPlugToPort_Points_singlePoints(handles[handleIndex], rtVals[handleIndex]);
+
     binding.setArgValue_lockType(lockType, argName, portRTVal, false);
   }
   catch(FabricCore::Exception e)
@@ -1455,6 +2045,123 @@ void dfgPlugToPort_Lines(MPlug &plug, MDataBlock &data,
   }
 }
 
+// Curves ports keep the complete NURBS description of every curve. The
+// degrees, forms, CVs (x, y, z, w) and knots of all curves are moved as
+// flat external arrays through the Maya helpers of the KL type, the same
+// way the Lines conversion works. The helpers ship with the plugin in the
+// FabricMaya extension (Module/Exts/FabricMaya). On the Maya side a Curves
+// port is a multi attribute with one nurbsCurve per element.
+template<typename Ty>
+static Ty * dfgVectorData(std::vector<Ty> & values)
+{
+  return values.size() > 0 ? &values[0] : NULL;
+}
+
+void dfgLoadMayaExtension()
+{
+  static bool loaded = false;
+  if(loaded)
+    return;
+  try
+  {
+    FabricSplice::DGGraph::loadExtension("FabricMaya");
+    loaded = true;
+  }
+  catch(FabricSplice::Exception e)
+  {
+    mayaLogErrorFunc(e.what());
+  }
+}
+
+void dfgPlugToPort_Curves(MPlug &plug, MDataBlock &data, 
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName,
+    DFGConversionTimers * timers)
+{
+  try
+  {
+    std::vector<MObject> curveObjs;
+
+    timers->stop();
+    if(plug.isArray())
+    {
+      MArrayDataHandle arrayHandle = data.inputArrayValue(plug);
+      unsigned int elements = arrayHandle.elementCount();
+      for(unsigned int i = 0; i < elements; ++i){
+        arrayHandle.jumpToArrayElement(i);
+        curveObjs.push_back(arrayHandle.inputValue().asNurbsCurve());
+      }
+    }
+    else
+      curveObjs.push_back(data.inputValue(plug).asNurbsCurve());
+    timers->resume();
+
+    unsigned int count = (unsigned int)curveObjs.size();
+    std::vector<uint32_t> degrees(count), forms(count), cvCounts(count), knotCounts(count);
+    std::vector<double> cvs, knots;
+
+    MPointArray curveCVs;
+    MDoubleArray curveKnots;
+    for(unsigned int i=0;i<count;i++)
+    {
+      MStatus status;
+      MFnNurbsCurve curve(curveObjs[i], &status);
+      if(status != MS::kSuccess)
+      {
+        degrees[i] = 1;
+        forms[i] = MFnNurbsCurve::kOpen;
+        cvCounts[i] = 0;
+        knotCounts[i] = 0;
+        continue;
+      }
+
+      curve.getCVs(curveCVs);
+      curve.getKnots(curveKnots);
+      degrees[i] = curve.degree();
+      forms[i] = curve.form();
+      cvCounts[i] = curveCVs.length();
+      knotCounts[i] = curveKnots.length();
+
+      size_t cvOffset = cvs.size();
+      cvs.resize(cvOffset + curveCVs.length() * 4);
+      if(curveCVs.length() > 0)
+        memcpy(&cvs[cvOffset], &curveCVs[0], sizeof(double) * 4 * curveCVs.length());
+
+      size_t knotOffset = knots.size();
+      knots.resize(knotOffset + curveKnots.length());
+      if(curveKnots.length() > 0)
+        memcpy(&knots[knotOffset], &curveKnots[0], sizeof(double) * curveKnots.length());
+    }
+
+    dfgLoadMayaExtension();
+    FabricCore::RTVal rtVal = binding.getArgValue(argName);
+    if(!rtVal.isValid() || rtVal.isNullObject())
+      rtVal = FabricSplice::constructObjectRTVal("Curves");
+
+    std::vector<FabricCore::RTVal> args(6);
+    args[0] = FabricSplice::constructExternalArrayRTVal("UInt32", degrees.size(), dfgVectorData(degrees));
+    args[1] = FabricSplice::constructExternalArrayRTVal("UInt32", forms.size(), dfgVectorData(forms));
+    args[2] = FabricSplice::constructExternalArrayRTVal("UInt32", cvCounts.size(), dfgVectorData(cvCounts));
+    args[3] = FabricSplice::constructExternalArrayRTVal("Float64", cvs.size(), dfgVectorData(cvs));
+    args[4] = FabricSplice::constructExternalArrayRTVal("UInt32", knotCounts.size(), dfgVectorData(knotCounts));
+    args[5] = FabricSplice::constructExternalArrayRTVal("Float64", knots.size(), dfgVectorData(knots));
+    rtVal.callMethod("", "_setFromMayaExternalArrays", 6, &args[0]);
+
+    binding.setArgValue_lockType(lockType, argName, rtVal, false);
+  }
+  catch(FabricCore::Exception e)
+  {
+    mayaLogErrorFunc(e.getDesc_cstr());
+    return;
+  }
+  catch(FabricSplice::Exception e)
+  {
+    mayaLogErrorFunc(e.what());
+    return;
+  }
+}
+
 void dfgPlugToPort_KeyframeTrack_helper(MFnAnimCurve & curve, FabricCore::RTVal & trackVal) {
 
   CORE_CATCH_BEGIN;
@@ -2384,13 +3091,27 @@ void dfgPortToPlug_integer(
     FabricCore::RTVal rtVal = binding.getArgValue(argName);
     unsigned int elements = rtVal.getArraySize();
 
-    FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
-    int32_t * values = (int32_t*)dataRtVal.getData();
-
-    for(unsigned int i = 0; i < elements; ++i){
-      MDataHandle handle = arraybuilder.addElement(i);
+    if(elements > 0)
+    {
+      DFGArrayElementKind kind = dfgGetArrayElementKind(binding, argName);
+      if(kind == DFG_ArrayElement_Unknown)
+        return;
 
-      handle.setInt(values[i]);
+      FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+      if(kind == DFG_ArrayElement_SInt32)
+      {
+        // the elements are read straight from the KL array
+        const int32_t * values = (const int32_t*)dataRtVal.getData();
+        for(unsigned int i = 0; i < elements; ++i)
+          arraybuilder.addElement(i).setInt(values[i]);
+      }
+      else
+      {
+        MIntArray values(elements);
+        dfgKLToMayaArrayData(kind, dataRtVal.getData(), &values[0], elements);
+        for(unsigned int i = 0; i < elements; ++i)
+          arraybuilder.addElement(i).setInt(values[i]);
+      }
     }
 
     arrayHandle.set(arraybuilder);
@@ -2407,11 +3128,8 @@ void dfgPortToPlug_integer(
       arrayValues.setLength(elements);
 
       FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
-      int32_t * values = (int32_t*)dataRtVal.getData();
-
-      for(unsigned int i = 0; i < elements; ++i){
-        arrayValues[i] = values[i];
-      }
+      if(elements > 0 && !dfgKLToMayaArrayData(dfgGetArrayElementKind(binding, argName), dataRtVal.getData(), &arrayValues[0], elements))
+        return;
 
       handle.set(MFnIntArrayData().create(arrayValues));
     }else{
@@ -2421,7 +3139,22 @@ void dfgPortToPlug_integer(
   }
 }
 
-void dfgPortToPlug_scalar(
+// sets a scalar handle from a value in the unit used on the KL side
+static void dfgSetScalarToHandle(MDataHandle handle, double value, const FTL::CStrRef & scalarUnit)
+{
+  if(scalarUnit == "time")
+    handle.setMTime(MTime(value, MTime::kSeconds));
+  else if(scalarUnit == "angle")
+    handle.setMAngle(MAngle(value, MAngle::kRadians));
+  else if(scalarUnit == "distance")
+    handle.setMDistance(MDistance(value, MDistance::kMillimeters));
+  else if(handle.numericType() == MFnNumericData::kFloat)
+    handle.setFloat((float)value);
+  else
+    handle.setDouble(value);
+}
+
+void dfgPortToPlug_scalar(
     FabricCore::DFGBinding & binding,
     FabricCore::LockType lockType,
     char const * argName, MPlug &plug, MDataBlock &data)
@@ -2436,24 +3169,26 @@ void dfgPortToPlug_scalar(
     FabricCore::RTVal rtVal = binding.getArgValue(argName);
     unsigned int elements = rtVal.getArraySize();
 
-    FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
-    float * values = (float*)dataRtVal.getData();
-
-    for(unsigned int i = 0; i < elements; ++i){
-      MDataHandle handle = arraybuilder.addElement(i);
+    if(elements > 0)
+    {
+      DFGArrayElementKind kind = dfgGetArrayElementKind(binding, argName);
+      if(kind == DFG_ArrayElement_Unknown)
+        return;
 
-      if(scalarUnit == "time")
-        handle.setMTime(MTime(values[i], MTime::kSeconds));
-      else if(scalarUnit == "angle")
-        handle.setMAngle(MAngle(values[i], MAngle::kRadians));
-      else if(scalarUnit == "distance")
-        handle.setMDistance(MDistance(values[i], MDistance::kMillimeters));
+      FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+      if(kind == DFG_ArrayElement_Float32)
+      {
+        // the elements are read straight from the KL array
+        const float * values = (const float*)dataRtVal.getData();
+        for(unsigned int i = 0; i < elements; ++i)
+          dfgSetScalarToHandle(arraybuilder.addElement(i), values[i], scalarUnit);
+      }
       else
       {
-        if(handle.numericType() == MFnNumericData::kFloat)
-          handle.setFloat(values[i]);
-        else
-          handle.setDouble(values[i]);
+        MDoubleArray values(elements);
+        dfgKLToMayaArrayData(kind, dataRtVal.getData(), &values[0], elements);
+        for(unsigned int i = 0; i < elements; ++i)
+          dfgSetScalarToHandle(arraybuilder.addElement(i), values[i], scalarUnit);
       }
     }
 
@@ -2466,14 +3201,13 @@ void dfgPortToPlug_scalar(
     if(rtVal.isArray()) {
 
       FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
-      float * floatValues = (float*)dataRtVal.getData();
 
       unsigned int elements = rtVal.getArraySize();
       MDoubleArray doubleValues;
       doubleValues.setLength(elements);
 
-      for(unsigned int i=0;i<elements;i++)
-        doubleValues[i] = floatValues[i];
+      if(elements > 0 && !dfgKLToMayaArrayData(dfgGetArrayElementKind(binding, argName), dataRtVal.getData(), &doubleValues[0], elements))
+        return;
 
       handle.set(MFnDoubleArrayData().create(doubleValues));
     }else{
@@ -2529,53 +3263,7 @@ void dfgPortToPlug_color(
     FabricCore::LockType lockType,
     char const * argName, MPlug &plug, MDataBlock &data)
 {
-  if(plug.isArray()){
-    MArrayDataHandle arrayHandle = data.outputArrayValue(plug);
-    MArrayDataBuilder arraybuilder = arrayHandle.builder();
-
-    FabricCore::RTVal arrayVal = binding.getArgValue(argName);
-    unsigned int elements = arrayVal.getArraySize();
-    for(unsigned int i = 0; i < elements; ++i){
-      MDataHandle handle = arraybuilder.addElement(i);
-      FabricCore::RTVal rtVal = arrayVal.getArrayElement(i);
-      if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat){
-        handle.setMFloatVector(MFloatVector(
-          (float)dfgGetFloat64FromRTVal(rtVal.maybeGetMember("r")),
-          (float)dfgGetFloat64FromRTVal(rtVal.maybeGetMember("g")),
-          (float)dfgGetFloat64FromRTVal(rtVal.maybeGetMember("b"))
-        ));
-      }else{
-        handle.setMVector(MVector(
-          dfgGetFloat64FromRTVal(rtVal.maybeGetMember("r")),
-          dfgGetFloat64FromRTVal(rtVal.maybeGetMember("g")),
-          dfgGetFloat64FromRTVal(rtVal.maybeGetMember("b"))
-        ));
-      }
-    }
-
-    arrayHandle.set(arraybuilder);
-    arrayHandle.setAllClean();
-  }
-  else{
-    MDataHandle handle = data.outputValue(plug);
-
-    FabricCore::RTVal rtVal = binding.getArgValue(argName);
-    if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat){
-      MFloatVector v(
-        (float)dfgGetFloat64FromRTVal(rtVal.maybeGetMember("r")),
-        (float)dfgGetFloat64FromRTVal(rtVal.maybeGetMember("g")),
-        (float)dfgGetFloat64FromRTVal(rtVal.maybeGetMember("b"))
-      );
-      handle.setMFloatVector(v);
-    }else{
-      MVector v(
-        dfgGetFloat64FromRTVal(rtVal.maybeGetMember("r")),
-        dfgGetFloat64FromRTVal(rtVal.maybeGetMember("g")),
-        dfgGetFloat64FromRTVal(rtVal.maybeGetMember("b"))
-      );
-      handle.setMVector(v);
-    }
-  }
+  dfgPortToPlug_podStruct(s_podLayoutColor, binding, lockType, argName, plug, data);
 }
 
 void dfgPortToPlug_vec3(
@@ -2678,51 +3366,178 @@ void dfgPortToPlug_euler(
     FabricCore::LockType lockType,
     char const * argName, MPlug &plug, MDataBlock &data)
 {
-  if(plug.isArray()){
-    MArrayDataHandle arrayHandle = data.outputArrayValue(plug);
-    MArrayDataBuilder arraybuilder = arrayHandle.builder();
+  dfgPortToPlug_podStruct(s_podLayoutEuler, binding, lockType, argName, plug, data);
+}
 
-    FabricCore::RTVal arrayVal = binding.getArgValue(argName);
-    unsigned int elements = arrayVal.getArraySize();
-    for(unsigned int i = 0; i < elements; ++i){
-      MDataHandle handle = arraybuilder.addElement(i);
-      FabricCore::RTVal rtVal = arrayVal.getArrayElement(i);
-      if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat){
-        handle.set3Float(
-          dfgGetFloat64FromRTVal(rtVal.maybeGetMember("x")),
-          dfgGetFloat64FromRTVal(rtVal.maybeGetMember("y")),
-          dfgGetFloat64FromRTVal(rtVal.maybeGetMember("z"))
-        );
-      }else{
-        handle.set3Double(
-          dfgGetFloat64FromRTVal(rtVal.maybeGetMember("x")),
-          dfgGetFloat64FromRTVal(rtVal.maybeGetMember("y")),
-          dfgGetFloat64FromRTVal(rtVal.maybeGetMember("z"))
-        );
+void dfgPortToPlug_vec2(
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName, MPlug &plug, MDataBlock &data)
+{
+  dfgPortToPlug_podStruct(s_podLayoutVec2, binding, lockType, argName, plug, data);
+}
+
+void dfgPortToPlug_vec4(
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName, MPlug &plug, MDataBlock &data)
+{
+  dfgPortToPlug_podStruct(s_podLayoutVec4, binding, lockType, argName, plug, data);
+}
+
+void dfgPortToPlug_quat(
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName, MPlug &plug, MDataBlock &data)
+{
+  dfgPortToPlug_podStruct(s_podLayoutQuat, binding, lockType, argName, plug, data);
+}
+
+// Mat44[] and Xfo[] outputs marked with the "instancer" metadata have a
+// kDynArrayAttrs attribute, converted in bulk to the position, rotation
+// and scale channels read by Maya's instancer
+static bool dfgIsInstancerPlug(MPlug &plug)
+{
+  MObject attribute = plug.attribute();
+  if(!attribute.hasFn(MFn::kTypedAttribute))
+    return false;
+  return MFnTypedAttribute(attribute).attrType() == MFnData::kDynArrayAttrs;
+}
+
+// copies the optional integer array of the port named in the
+// metadata into the given instancer channel
+static void dfgInstancerIndexChannel(
+  FabricCore::DFGBinding & binding,
+  char const * argName,
+  char const * metadataKey,
+  unsigned int count,
+  MDoubleArray & channel)
+{
+  FTL::CStrRef sourcePort = binding.getExec().getExecPortMetadata(argName, metadataKey);
+  if(sourcePort.empty() || !binding.getExec().haveExecPort(sourcePort.c_str()))
+    return;
+
+  FTL::CStrRef sourceType = binding.getExec().getExecPortResolvedType(sourcePort.c_str());
+  bool isSigned = sourceType == "SInt32[]" || sourceType == "Integer[]";
+  bool isUnsigned = sourceType == "UInt32[]" || sourceType == "Index[]";
+  if(!isSigned && !isUnsigned)
+  {
+    mayaLogErrorFunc("Instancer channel port '"+MString(sourcePort.c_str())+"' has to be a SInt32[] or UInt32[].");
+    return;
+  }
+
+  FabricCore::RTVal rtVal = binding.getArgValue(sourcePort.c_str());
+  if(!rtVal.isArray() || rtVal.getArraySize() != count || count == 0)
+    return;
+
+  FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+  if(isSigned)
+  {
+    const int32_t * values = (const int32_t*)dataRtVal.getData();
+    for(unsigned int i=0;i<count;i++)
+      channel[i] = (double)values[i];
+  }
+  else
+  {
+    const uint32_t * values = (const uint32_t*)dataRtVal.getData();
+    for(unsigned int i=0;i<count;i++)
+      channel[i] = (double)values[i];
+  }
+}
+
+void dfgPortToPlug_instancer(
+    FabricCore::DFGBinding & binding,
+    char const * argName, MPlug &plug, MDataBlock &data, bool isXfo)
+{
+  CORE_CATCH_BEGIN;
+
+  // the Xfo elements are read in place
+  if(isXfo && !dfgCheckPODStructLayout(s_podLayoutXfo))
+    return;
+
+  const double radToDeg = 180.0 / 3.14159265358979323846;
+
+  FabricCore::RTVal rtVal = binding.getArgValue(argName);
+  unsigned int count = rtVal.isArray() ? rtVal.getArraySize() : 0;
+
+  MFnArrayAttrsData arrayAttrsFn;
+  MObject arrayAttrsObj = arrayAttrsFn.create();
+
+  MVectorArray positions = arrayAttrsFn.vectorArray("position");
+  MVectorArray rotations = arrayAttrsFn.vectorArray("rotation");
+  MVectorArray scales = arrayAttrsFn.vectorArray("scale");
+  MDoubleArray ids = arrayAttrsFn.doubleArray("id");
+  positions.setLength(count);
+  rotations.setLength(count);
+  scales.setLength(count);
+  ids.setLength(count);
+
+  if(count > 0)
+  {
+    FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+    if(isXfo)
+    {
+      const KLXfo * xfos = (const KLXfo*)dataRtVal.getData();
+      for(unsigned int i=0;i<count;i++)
+      {
+        const KLXfo & xfo = xfos[i];
+        MEulerRotation euler = MQuaternion(xfo.ori.x, xfo.ori.y, xfo.ori.z, xfo.ori.w).asEulerRotation();
+        positions[i] = MVector(xfo.tr.x, xfo.tr.y, xfo.tr.z);
+        rotations[i] = MVector(euler.x * radToDeg, euler.y * radToDeg, euler.z * radToDeg);
+        scales[i] = MVector(xfo.sc.x, xfo.sc.y, xfo.sc.z);
+        ids[i] = (double)i;
+      }
+    }
+    else
+    {
+      const float * values = (const float*)dataRtVal.getData();
+      for(unsigned int i=0;i<count;i++)
+      {
+        MMatrix mayaMat;
+        Mat44ToMMatrix_data(&values[i * 16], mayaMat);
+        MTransformationMatrix transform(mayaMat);
+
+        double scale[3];
+        transform.getScale(scale, MSpace::kTransform);
+        MEulerRotation euler = transform.eulerRotation();
+        positions[i] = transform.getTranslation(MSpace::kTransform);
+        rotations[i] = MVector(euler.x * radToDeg, euler.y * radToDeg, euler.z * radToDeg);
+        scales[i] = MVector(scale[0], scale[1], scale[2]);
+        ids[i] = (double)i;
       }
     }
 
-    arrayHandle.set(arraybuilder);
-    arrayHandle.setAllClean();
-  }
-  else{
-    MDataHandle handle = data.outputValue(plug);
+    dfgInstancerIndexChannel(binding, argName, "instancerIds", count, ids);
 
-    FabricCore::RTVal rtVal = binding.getArgValue(argName);
-    if(handle.numericType() == MFnNumericData::k3Float || handle.numericType() == MFnNumericData::kFloat){
-      handle.set3Float(
-        dfgGetFloat64FromRTVal(rtVal.maybeGetMember("x")),
-        dfgGetFloat64FromRTVal(rtVal.maybeGetMember("y")),
-        dfgGetFloat64FromRTVal(rtVal.maybeGetMember("z"))
-      );
-    }else{
-      handle.set3Double(
-        dfgGetFloat64FromRTVal(rtVal.maybeGetMember("x")),
-        dfgGetFloat64FromRTVal(rtVal.maybeGetMember("y")),
-        dfgGetFloat64FromRTVal(rtVal.maybeGetMember("z"))
-      );
+    FTL::CStrRef objectIndicesPort = binding.getExec().getExecPortMetadata(argName, "instancerObjectIndices");
+    if(!objectIndicesPort.empty())
+    {
+      MDoubleArray objectIndices = arrayAttrsFn.doubleArray("objectIndex");
+      objectIndices.setLength(count);
+      for(unsigned int i=0;i<count;i++)
+        objectIndices[i] = 0.0;
+      dfgInstancerIndexChannel(binding, argName, "instancerObjectIndices", count, objectIndices);
     }
   }
+
+  MDataHandle handle = data.outputValue(plug);
+  handle.set(arrayAttrsObj);
+  handle.setClean();
+
+  CORE_CATCH_END;
+}
+
+void dfgPortToPlug_xfo(
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName, MPlug &plug, MDataBlock &data)
+{
+  if(dfgIsInstancerPlug(plug))
+  {
+    dfgPortToPlug_instancer(binding, argName, plug, data, true);
+    return;
+  }
+  dfgPortToPlug_podStruct(s_podLayoutXfo, binding, lockType, argName, plug, data);
 }
 
 void dfgPortToPlug_mat44(
@@ -2730,6 +3545,12 @@ void dfgPortToPlug_mat44(
     FabricCore::LockType lockType,
     char const * argName, MPlug &plug, MDataBlock &data)
 {
+  if(dfgIsInstancerPlug(plug))
+  {
+    dfgPortToPlug_instancer(binding, argName, plug, data, false);
+    return;
+  }
+
   if(plug.isArray()){
     MArrayDataHandle arrayHandle = data.outputArrayValue(plug);
     MArrayDataBuilder arraybuilder = arrayHandle.builder();
@@ -2861,22 +3682,8 @@ void dfgPortToPlug_PolygonMesh_singleMesh(MDataHandle handle, FabricCore::RTVal
     MIntArray normalFace, normalVertex;
     normalFace.setLength( mayaIndices.length() );
     normalVertex.setLength( mayaIndices.length() );
-
-    int face = 0;
-    int vertex = 0;
-    int offset = 0;
-
-    for( unsigned int i = 0; i < mayaIndices.length(); i++ ) {
-      normalFace[i] = face;
-      normalVertex[i] = mayaIndices[offset + vertex];
-      vertex++;
-
-      if( vertex == mayaCounts[face] ) {
-        offset += mayaCounts[face];
-        face++;
-        vertex = 0;
-      }
-    }
+    if(mayaIndices.length() > 0)
+      FabricMaya::Kernels::BuildFaceVertexIds(&mayaCounts[0], mayaCounts.length(), &mayaIndices[0], mayaIndices.length(), &normalFace[0], &normalVertex[0]);
 
     mesh.create( mayaPoints.length(), mayaCounts.length(), mayaPoints, mayaCounts, mayaIndices, meshObject );
     mesh.updateSurface();
@@ -2959,7 +3766,17 @@ void dfgPortToPlug_PolygonMesh(
       FabricCore::RTVal polygonMeshArray = binding.getArgValue(argName);
       unsigned int elements = polygonMeshArray.getArraySize();
       for(unsigned int i = 0; i < elements; ++i)
-        dfgPortToPlug_PolygonMesh_singleMesh(arraybuilder.addElement(i), polygonMeshArray.getArrayElement(i));
+      {
+        MPlug elementPlug = plug.elementByLogicalIndex(i);
+        FabricCore::RTVal polygonMesh = polygonMeshArray.getArrayElement(i);
+        if(FabricMayaMeshChannel::publish(elementPlug, polygonMesh))
+        {
+          arraybuilder.addElement(i).set(FabricMayaMeshChannel::createPlaceholderMesh());
+          continue;
+        }
+        FabricMayaMeshChannel::withdraw(elementPlug);
+        dfgPortToPlug_PolygonMesh_singleMesh(arraybuilder.addElement(i), polygonMesh);
+      }
 
       arrayHandle.set(arraybuilder);
       arrayHandle.setAllClean();
@@ -2967,7 +3784,18 @@ void dfgPortToPlug_PolygonMesh(
     else
     {
       MDataHandle handle = data.outputValue(plug.attribute());
-      dfgPortToPlug_PolygonMesh_singleMesh(handle, binding.getArgValue(argName));
+      FabricCore::RTVal polygonMesh = binding.getArgValue(argName);
+
+      // only Canvas and Splice nodes read this output, they pick up the
+      // mesh from the channel so the conversion to Maya can be skipped
+      if(FabricMayaMeshChannel::publish(plug, polygonMesh))
+      {
+        handle.set(FabricMayaMeshChannel::createPlaceholderMesh());
+        handle.setClean();
+        return;
+      }
+      FabricMayaMeshChannel::withdraw(plug);
+      dfgPortToPlug_PolygonMesh_singleMesh(handle, polygonMesh);
     }
   }
   catch(FabricCore::Exception e)
@@ -3083,6 +3911,309 @@ void dfgPortToPlug_Lines(
   }
 }
 
+void dfgPortToPlug_Curves_singleCurve(
+  MDataHandle handle,
+  unsigned int degree,
+  unsigned int form,
+  const double * cvs,
+  unsigned int numCVs,
+  const double * knots,
+  unsigned int numKnots)
+{
+  CORE_CATCH_BEGIN;
+
+  MPointArray mayaCVs(numCVs);
+  bool rational = false;
+  if(numCVs > 0)
+  {
+    memcpy(&mayaCVs[0], cvs, sizeof(double) * 4 * numCVs);
+    for(unsigned int i=0;i<numCVs && !rational;i++)
+      rational = cvs[i*4+3] != 1.0;
+  }
+
+  // the curve of the previous evaluation is updated in
+  // place as long as only its CVs have changed
+  MStatus status;
+  MObject curveObject = handle.asNurbsCurve();
+  MFnNurbsCurve curve(curveObject, &status);
+  if(status == MS::kSuccess && !curveObject.isNull() &&
+    curve.degree() == (int)degree && (unsigned int)curve.form() == form &&
+    curve.numCVs() == (int)numCVs && curve.numKnots() == (int)numKnots)
+  {
+    MDoubleArray currentKnots;
+    curve.getKnots(currentKnots);
+    bool sameKnots = true;
+    for(unsigned int i=0;i<numKnots && sameKnots;i++)
+      sameKnots = currentKnots[i] == knots[i];
+
+    if(sameKnots)
+    {
+      curve.setCVs(mayaCVs);
+      curve.updateCurve();
+      handle.setClean();
+      return;
+    }
+  }
+
+  MFnNurbsCurveData curveDataFn;
+  curveObject = curveDataFn.create();
+
+  MDoubleArray mayaKnots(knots, numKnots);
+  MFnNurbsCurve newCurve;
+  newCurve.create(
+    mayaCVs, mayaKnots, degree,
+    (MFnNurbsCurve::Form)form,
+    false,
+    rational,
+    curveObject);
+
+  handle.set(curveObject);
+  handle.setClean();
+
+  CORE_CATCH_END;
+}
+
+void dfgPortToPlug_Curves(
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName, MPlug &plug, MDataBlock &data)
+{
+  try
+  {
+    FabricCore::RTVal rtVal = binding.getArgValue(argName);
+    unsigned int count = 0;
+    if(rtVal.isValid() && !rtVal.isNullObject())
+      count = rtVal.callMethod("UInt32", "curveCount", 0, 0).getUInt32();
+
+    std::vector<uint32_t> degrees(count), forms(count), cvCounts(count), knotCounts(count);
+    std::vector<double> cvs, knots;
+    if(count > 0)
+    {
+      dfgLoadMayaExtension();
+      std::vector<FabricCore::RTVal> args(4);
+      args[0] = FabricSplice::constructExternalArrayRTVal("UInt32", count, &degrees[0]);
+      args[1] = FabricSplice::constructExternalArrayRTVal("UInt32", count, &forms[0]);
+      args[2] = FabricSplice::constructExternalArrayRTVal("UInt32", count, &cvCounts[0]);
+      args[3] = FabricSplice::constructExternalArrayRTVal("UInt32", count, &knotCounts[0]);
+      rtVal.callMethod("", "_getMayaStructureAsExternalArrays", 4, &args[0]);
+
+      size_t totalCVs = 0;
+      size_t totalKnots = 0;
+      for(unsigned int i=0;i<count;i++)
+      {
+        totalCVs += cvCounts[i];
+        totalKnots += knotCounts[i];
+      }
+      cvs.resize(totalCVs * 4);
+      knots.resize(totalKnots);
+
+      args.resize(2);
+      args[0] = FabricSplice::constructExternalArrayRTVal("Float64", cvs.size(), dfgVectorData(cvs));
+      args[1] = FabricSplice::constructExternalArrayRTVal("Float64", knots.size(), dfgVectorData(knots));
+      rtVal.callMethod("", "_getMayaDataAsExternalArrays", 2, &args[0]);
+    }
+
+    // Curves ports are always multi attributes
+    MArrayDataHandle arrayHandle = data.outputArrayValue(plug);
+    MArrayDataBuilder arraybuilder = arrayHandle.builder();
+
+    // drop the elements of curves which don't exist anymore
+    std::vector<unsigned int> removedIndices;
+    for(unsigned int i = 0; i < arrayHandle.elementCount(); ++i){
+      arrayHandle.jumpToArrayElement(i);
+      if(arrayHandle.elementIndex() >= count)
+        removedIndices.push_back(arrayHandle.elementIndex());
+    }
+    for(size_t i = 0; i < removedIndices.size(); ++i)
+      arraybuilder.removeElement(removedIndices[i]);
+
+    size_t cvOffset = 0;
+    size_t knotOffset = 0;
+    for(unsigned int i = 0; i < count; ++i)
+    {
+      dfgPortToPlug_Curves_singleCurve(
+        arraybuilder.addElement(i),
+        degrees[i], forms[i],
+        dfgVectorData(cvs) + cvOffset * 4, cvCounts[i],
+        dfgVectorData(knots) + knotOffset, knotCounts[i]);
+      cvOffset += cvCounts[i];
+      knotOffset += knotCounts[i];
+    }
+
+    arrayHandle.set(arraybuilder);
+    arrayHandle.setAllClean();
+  }
+  catch(FabricCore::Exception e)
+  {
+    mayaLogErrorFunc(e.getDesc_cstr());
+    return;
+  }
+  catch(FabricSplice::Exception e)
+  {
+    mayaLogErrorFunc(e.what());
+    return;
+  }
+}
+
+struct DFGPointsChannel
+{
+  MString attributeName;
+  MString channelName;
+  std::string type;
+};
+
+// parses the "particleChannels" metadata of the port, a comma separated
+// list of attributes with their type, for example "velocity:Vec3,radiusPP:Scalar"
+static std::vector<DFGPointsChannel> dfgGetPointsChannels(FabricCore::DFGBinding & binding, char const * argName)
+{
+  std::vector<DFGPointsChannel> channels;
+
+  DFGPointsChannel positions;
+  positions.attributeName = "positions";
+  positions.channelName = "position";
+  positions.type = "Vec3";
+  channels.push_back(positions);
+
+  MString channelsMD = binding.getExec().getExecPortMetadata(argName, "particleChannels");
+  MStringArray entries;
+  channelsMD.split(',', entries);
+  for(unsigned int i=0;i<entries.length();i++)
+  {
+    MStringArray parts;
+    entries[i].split(':', parts);
+    if(parts.length() != 2)
+      continue;
+
+    DFGPointsChannel channel;
+    channel.attributeName = parts[0];
+    channel.channelName = dfgPointsChannelName(parts[0]);
+    channel.type = parts[1].asChar();
+    if(channel.type != "Vec3" && channel.type != "Scalar" && channel.type != "Integer")
+    {
+      mayaLogErrorFunc("Unsupported particle channel type '"+parts[1]+"' on port '"+MString(argName)+"'.");
+      continue;
+    }
+    if(channel.attributeName == "positions")
+      continue;
+    channels.push_back(channel);
+  }
+
+  return channels;
+}
+
+void dfgPortToPlug_Points_singlePoints(MDataHandle handle, FabricCore::RTVal points, const std::vector<DFGPointsChannel> & channels)
+{
+  CORE_CATCH_BEGIN;
+
+  MFnArrayAttrsData arrayAttrsFn;
+  MObject arrayAttrsObj = arrayAttrsFn.create();
+
+  if(points.isValid() && !points.isNullObject())
+  {
+    FabricCore::RTVal attributes = points.maybeGetMember("attributes");
+
+    for(size_t i=0;i<channels.size();i++)
+    {
+      const DFGPointsChannel & channel = channels[i];
+      FabricCore::RTVal nameVal = FabricSplice::constructStringRTVal(channel.attributeName.asChar());
+
+      if(channel.type == "Vec3")
+      {
+        FabricCore::RTVal attribute = attributes.callMethod("Vec3Attribute", "getOrCreateVec3Attribute", 1, &nameVal);
+        FabricCore::RTVal rtVal = attribute.maybeGetMember("values");
+        unsigned int count = rtVal.getArraySize();
+
+        MVectorArray values = arrayAttrsFn.vectorArray(channel.channelName);
+        values.setLength(count);
+        if(count == 0)
+          continue;
+
+        FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+        const float * src = (const float*)dataRtVal.getData();
+        double * dst = &values[0].x;
+        for(unsigned int j=0;j<count*3;j++)
+          dst[j] = (double)src[j];
+      }
+      else if(channel.type == "Scalar")
+      {
+        FabricCore::RTVal attribute = attributes.callMethod("ScalarAttribute", "getOrCreateScalarAttribute", 1, &nameVal);
+        FabricCore::RTVal rtVal = attribute.maybeGetMember("values");
+        unsigned int count = rtVal.getArraySize();
+
+        MDoubleArray values = arrayAttrsFn.doubleArray(channel.channelName);
+        values.setLength(count);
+        if(count == 0)
+          continue;
+
+        FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+        const float * src = (const float*)dataRtVal.getData();
+        double * dst = &values[0];
+        for(unsigned int j=0;j<count;j++)
+          dst[j] = (double)src[j];
+      }
+      else
+      {
+        FabricCore::RTVal attribute = attributes.callMethod("IntegerAttribute", "getOrCreateIntegerAttribute", 1, &nameVal);
+        FabricCore::RTVal rtVal = attribute.maybeGetMember("values");
+        unsigned int count = rtVal.getArraySize();
+
+        MIntArray values = arrayAttrsFn.intArray(channel.channelName);
+        values.setLength(count);
+        if(count == 0)
+          continue;
+
+        FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+        memcpy(&values[0], dataRtVal.getData(), sizeof(int32_t) * count);
+      }
+    }
+  }
+
+  handle.set(arrayAttrsObj);
+  handle.setClean();
+
+  CORE_CATCH_END;
+}
+
+void dfgPortToPlug_Points(
+    FabricCore::DFGBinding & binding,
+    FabricCore::LockType lockType,
+    char const * argName, MPlug &plug, MDataBlock &data)
+{
+  try
+  {
+    std::vector<DFGPointsChannel> channels = dfgGetPointsChannels(binding, argName);
+
+    if(plug.isArray())
+    {
+      MArrayDataHandle arrayHandle = data.outputArrayValue(plug);
+      MArrayDataBuilder arraybuilder = arrayHandle.builder();
+
+      FabricCore::RTVal rtVal = binding.getArgValue(argName);
+      unsigned int elements = rtVal.getArraySize();
+      for(unsigned int i = 0; i < elements; ++i)
+        dfgPortToPlug_Points_singlePoints(arraybuilder.addElement(i), rtVal.getArrayElement(i), channels);
+
+      arrayHandle.set(arraybuilder);
+      arrayHandle.setAllClean();
+    }
+    else
+    {
+      MDataHandle handle = data.outputValue(plug.attribute());
+      dfgPortToPlug_Points_singlePoints(handle, binding.getArgValue(argName), channels);
+    }
+  }
+  catch(FabricCore::Exception e)
+  {
+    mayaLogErrorFunc(e.getDesc_cstr());
+    return;
+  }
+  catch(FabricSplice::Exception e)
+  {
+    mayaLogErrorFunc(e.what());
+    return;
+  }
+}
+
 void dfgPortToPlug_spliceMayaData(
     FabricCore::DFGBinding & binding,
     FabricCore::LockType lockType,
@@ -3158,6 +4289,14 @@ DFGPlugToArgFunc getDFGPlugToArgFunc(const FTL::CStrRef &dataType)
 
   if (dataType == "Euler")                return dfgPlugToPort_euler;
 
+  if (dataType == "Vec2")                 return dfgPlugToPort_vec2;
+
+  if (dataType == "Vec4")                 return dfgPlugToPort_vec4;
+
+  if (dataType == "Quat")                 return dfgPlugToPort_quat;
+
+  if (dataType == "Xfo")                  return dfgPlugToPort_xfo;
+
   if (dataType == "Mat44")                return dfgPlugToPort_mat44;
 
   if (dataType == "Color")                return dfgPlugToPort_color;
@@ -3166,6 +4305,10 @@ DFGPlugToArgFunc getDFGPlugToArgFunc(const FTL::CStrRef &dataType)
 
   if (dataType == "Lines")                return dfgPlugToPort_Lines;
 
+  if (dataType == "Curves")               return dfgPlugToPort_Curves;
+
+  if (dataType == "Points")               return dfgPlugToPort_Points;
+
   if (dataType == "KeyframeTrack")        return dfgPlugToPort_KeyframeTrack;
 
   if (dataType == "SpliceMayaData")      return dfgPlugToPort_spliceMayaData;
@@ -3206,6 +4349,14 @@ DFGArgToPlugFunc getDFGArgToPlugFunc(const FTL::CStrRef &dataType)
 
   if (dataType == "Euler")                return dfgPortToPlug_euler;
 
+  if (dataType == "Vec2")                 return dfgPortToPlug_vec2;
+
+  if (dataType == "Vec4")                 return dfgPortToPlug_vec4;
+
+  if (dataType == "Quat")                 return dfgPortToPlug_quat;
+
+  if (dataType == "Xfo")                  return dfgPortToPlug_xfo;
+
   if (dataType == "Mat44")                return dfgPortToPlug_mat44;
 
   if (dataType == "Color")                return dfgPortToPlug_color;
@@ -3214,6 +4365,10 @@ DFGArgToPlugFunc getDFGArgToPlugFunc(const FTL::CStrRef &dataType)
 
   if (dataType == "Lines")                return dfgPortToPlug_Lines;
 
+  if (dataType == "Curves")               return dfgPortToPlug_Curves;
+
+  if (dataType == "Points")               return dfgPortToPlug_Points;
+
   if (dataType == "SpliceMayaData")      return dfgPortToPlug_spliceMayaData;
 
   if(dataType == "CompoundParam")         return dfgPortToPlug_compound;
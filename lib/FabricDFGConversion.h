@@ -59,5 +59,9 @@ typedef void(*DFGArgToPlugFunc)(
   MDataBlock &data
   );
 
+// loads the FabricMaya extension shipped with the plugin
+// (Module/Exts/FabricMaya), it holds the KL helpers of the conversions
+void dfgLoadMayaExtension();
+
 DFGPlugToArgFunc getDFGPlugToArgFunc(const FTL::CStrRef &dataType);
 DFGArgToPlugFunc getDFGArgToPlugFunc(const FTL::CStrRef &dataType);
@@ -10,6 +10,13 @@
 #include <maya/MFnDependencyNode.h>
 #include <maya/MFnTypedAttribute.h>
 #include <maya/MFnNumericAttribute.h>
+#include <maya/MPointArray.h>
+#include <maya/MFnMesh.h>
+#include <maya/MArrayDataHandle.h>
+
+#include <string.h>
+
+#include <FTL/AutoSet.h>
 
 MTypeId FabricDFGMayaDeformer::id(0x0011AE48);
 MObject FabricDFGMayaDeformer::saveData;
@@ -57,6 +64,20 @@ MStatus FabricDFGMayaDeformer::initialize(){
   return MS::kSuccess;
 }
 
+// all of the points of the input mesh, including the ones which
+// aren't members of the deformer set
+static bool getInputMeshPoints(MDataBlock& block, MObject & inputAttr, MObject & inputGeomAttr, unsigned int multiIndex, MPointArray & points)
+{
+  MStatus status;
+  MArrayDataHandle inputHandle = block.outputArrayValue(inputAttr, &status);
+  if(status != MS::kSuccess || inputHandle.jumpToElement(multiIndex) != MS::kSuccess)
+    return false;
+  MFnMesh mesh(inputHandle.outputValue().child(inputGeomAttr).asMesh(), &status);
+  if(status != MS::kSuccess)
+    return false;
+  return mesh.getPoints(points) == MS::kSuccess;
+}
+
 MStatus FabricDFGMayaDeformer::deform(MDataBlock& block, MItGeometry& iter, const MMatrix&, unsigned int multiIndex)
 {
   _outputsDirtied = false;
@@ -70,6 +91,11 @@ MStatus FabricDFGMayaDeformer::deform(MDataBlock& block, MItGeometry& iter, cons
 
   if (stateData.asShort() == 0)       // 0: Normal.
   {
+    // nothing to do without an envelope
+    float envelopeValue = block.inputValue(envelope).asFloat();
+    if (envelopeValue == 0.0f)
+      return MS::kSuccess;
+
     MAYADFG_CATCH_BEGIN(&stat);
 
     FabricSplice::Logging::AutoTimer timer("Maya::deform()");
@@ -116,31 +142,159 @@ MStatus FabricDFGMayaDeformer::deform(MDataBlock& block, MItGeometry& iter, cons
       if(!rtMesh.isValid() || rtMesh.isNullObject())
         return MStatus::kSuccess;
 
+      // the iterator only visits the members of the deformer set,
+      // gather the indices, weights and positions of the members
+      // with a non-zero weight, the others are left untouched
       MPointArray mayaPoints;
       iter.allPositions(mayaPoints);
+      unsigned int numMembers = mayaPoints.length();
+      if(numMembers == 0)
+        return MStatus::kSuccess;
+
+      mActiveIndices.clear();
+      mActiveMembers.clear();
+      mActiveWeights.clear();
+      mActivePoints.clear();
+      unsigned int maxIndex = 0;
+      bool partial = false;
+      bool weighted = envelopeValue != 1.0f;
+
+      const double * mayaData = &mayaPoints[0].x;
+      unsigned int member = 0;
+      for(iter.reset(); !iter.isDone() && member < numMembers; iter.next(), member++)
+      {
+        unsigned int index = (unsigned int)iter.index();
+        float weight = weightValue(block, multiIndex, index);
+        partial = partial || index != member;
+        if(weight == 0.0f)
+        {
+          partial = true;
+          continue;
+        }
+        weighted = weighted || weight != 1.0f;
+        maxIndex = index > maxIndex ? index : maxIndex;
+        mActiveIndices.push_back(index);
+        mActiveMembers.push_back(member);
+        mActiveWeights.push_back(weight);
+        mActivePoints.insert(mActivePoints.end(), mayaData + member * 4, mayaData + member * 4 + 4);
+      }
+
+      // all of the members are painted out
+      unsigned int numActive = (unsigned int)mActiveIndices.size();
+      if(numActive == 0)
+        return MStatus::kSuccess;
+
+      unsigned int nbPoints = 0;
+      try
+      {
+        nbPoints = (unsigned int)rtMesh.callMethod("UInt64", "pointCount", 0, 0).getUInt64();
+      }
+      catch(FabricCore::Exception e)
+      {
+        mayaLogErrorFunc(e.getDesc_cstr());
+        return MStatus::kSuccess;
+      }
+      partial = partial || nbPoints != numMembers;
+      if(partial && maxIndex >= nbPoints)
+      {
+        mayaLogFunc("FabricDFGMayaDeformer: the deformer set doesn't match the mesh in port \"meshes\"");
+        return MStatus::kSuccess;
+      }
+
+      // the mesh is modified in place by the graph, so all of its points
+      // are reset from the input geometry on every evaluation. Only the
+      // graphs with a memberIndices port, which process the members only,
+      // get the active points written for a partial membership
+      bool sparse = partial && exec.haveExecPort("memberIndices") &&
+        exec.getExecPortResolvedType("memberIndices") == std::string("UInt32[]");
+      MPointArray meshPoints;
+      if(partial && !sparse)
+      {
+        if(!getInputMeshPoints(block, input, inputGeom, multiIndex, meshPoints) || meshPoints.length() != nbPoints)
+        {
+          mayaLogFunc("FabricDFGMayaDeformer: the deformer set doesn't match the mesh in port \"meshes\"");
+          return MStatus::kSuccess;
+        }
+      }
 
+      FabricCore::RTVal indicesRTVal;
       try
       {
-        std::vector<FabricCore::RTVal> args(2);
-        args[0] = FabricSplice::constructExternalArrayRTVal("Float64", mayaPoints.length() * 4, &mayaPoints[0]);
-        args[1] = FabricSplice::constructUInt32RTVal(4); // components
-        rtMesh.callMethod("", "setPointsFromExternalArray_d", 2, &args[0]);
+        std::vector<FabricCore::RTVal> args(3);
+        if(sparse)
+        {
+          dfgLoadMayaExtension();
+          indicesRTVal = FabricSplice::constructExternalArrayRTVal("UInt32", numActive, &mActiveIndices[0]);
+          args[0] = indicesRTVal;
+          args[1] = FabricSplice::constructExternalArrayRTVal("Float64", mActivePoints.size(), &mActivePoints[0]);
+          args[2] = FabricSplice::constructUInt32RTVal(4); // components
+          rtMesh.callMethod("", "_setPointsAtIndicesFromExternalArray_d", 3, &args[0]);
+        }
+        else
+        {
+          MPointArray & points = partial ? meshPoints : mayaPoints;
+          args[0] = FabricSplice::constructExternalArrayRTVal("Float64", points.length() * 4, &points[0]);
+          args[1] = FabricSplice::constructUInt32RTVal(4); // components
+          rtMesh.callMethod("", "setPointsFromExternalArray_d", 2, &args[0]);
+        }
       }
       catch(FabricCore::Exception e)
       {
         mayaLogErrorFunc(e.getDesc_cstr());
         return MStatus::kSuccess;
       }
-      binding.setArgValue(portName.asChar(), rtValToSet, false);
+      {
+        // these are inputs of the evaluation, like the ones
+        // set by transferInputValuesToDFG
+        FTL::AutoSet<bool> transfersInputs(_isTransferingInputs, true);
+        binding.setArgValue(portName.asChar(), rtValToSet, false);
+        addRecordedInput(portName.asChar());
+        transferMembersToDFG(mActiveIndices, mActiveWeights);
+      }
 
       evaluate();
 
+      // the deformed positions of the active points are read back
+      // into the member-sized buffer, the others keep their input
+      MPointArray deformedPoints;
       try
       {
-        std::vector<FabricCore::RTVal> args(2);
-        args[0] = FabricSplice::constructExternalArrayRTVal("Float64", mayaPoints.length() * 4, &mayaPoints[0]);
-        args[1] = FabricSplice::constructUInt32RTVal(4); // components
-        rtMesh.callMethod("", "getPointsAsExternalArray_d", 2, &args[0]);
+        std::vector<FabricCore::RTVal> args(3);
+        if(sparse)
+        {
+          deformedPoints = mayaPoints;
+          args[0] = indicesRTVal;
+          args[1] = FabricSplice::constructExternalArrayRTVal("Float64", mActivePoints.size(), &mActivePoints[0]);
+          args[2] = FabricSplice::constructUInt32RTVal(4); // components
+          rtMesh.callMethod("", "_getPointsAtIndicesAsExternalArray_d", 3, &args[0]);
+
+          double * dst = &deformedPoints[0].x;
+          for(unsigned int i=0;i<numActive;i++)
+          {
+            double * point = dst + mActiveMembers[i] * 4;
+            point[0] = mActivePoints[i*4+0];
+            point[1] = mActivePoints[i*4+1];
+            point[2] = mActivePoints[i*4+2];
+          }
+        }
+        else if(partial)
+        {
+          // the whole mesh is read back, only the active members are taken
+          deformedPoints = mayaPoints;
+          args[0] = FabricSplice::constructExternalArrayRTVal("Float64", meshPoints.length() * 4, &meshPoints[0]);
+          args[1] = FabricSplice::constructUInt32RTVal(4); // components
+          rtMesh.callMethod("", "getPointsAsExternalArray_d", 2, &args[0]);
+
+          for(unsigned int i=0;i<numActive;i++)
+            deformedPoints[mActiveMembers[i]] = meshPoints[mActiveIndices[i]];
+        }
+        else
+        {
+          deformedPoints.setLength(numMembers);
+          args[0] = FabricSplice::constructExternalArrayRTVal("Float64", deformedPoints.length() * 4, &deformedPoints[0]);
+          args[1] = FabricSplice::constructUInt32RTVal(4); // components
+          rtMesh.callMethod("", "getPointsAsExternalArray_d", 2, &args[0]);
+        }
       }
       catch(FabricCore::Exception e)
       {
@@ -148,7 +302,23 @@ MStatus FabricDFGMayaDeformer::deform(MDataBlock& block, MItGeometry& iter, cons
         return MStatus::kSuccess;
       }
 
-      iter.setAllPositions(mayaPoints);
+      // blend between the input and the deformed positions
+      if(weighted)
+      {
+        const double * src = &mayaPoints[0].x;
+        double * dst = &deformedPoints[0].x;
+        for(unsigned int i=0;i<numActive;i++)
+        {
+          unsigned int o = mActiveMembers[i] * 4;
+          double w = (double)(mActiveWeights[i] * envelopeValue);
+          dst[o+0] = src[o+0] + (dst[o+0] - src[o+0]) * w;
+          dst[o+1] = src[o+1] + (dst[o+1] - src[o+1]) * w;
+          dst[o+2] = src[o+2] + (dst[o+2] - src[o+2]) * w;
+          dst[o+3] = src[o+3];
+        }
+      }
+
+      iter.setAllPositions(deformedPoints);
       transferOutputValuesToMaya(block, true);
     }
 
@@ -196,6 +366,32 @@ void FabricDFGMayaDeformer::invalidateNode()
   mGeometryInitialized = false;
 }
 
+void FabricDFGMayaDeformer::transferMembersToDFG(const std::vector<unsigned int> & indices, const std::vector<float> & weights)
+{
+  // optional ports, for graphs which only process the members
+  FabricCore::DFGExec exec = getDFGExec();
+  if(exec.haveExecPort("memberIndices") &&
+    exec.getExecPortResolvedType("memberIndices") == std::string("UInt32[]"))
+  {
+    FabricCore::RTVal rtVal = FabricSplice::constructVariableArrayRTVal("UInt32");
+    rtVal.setArraySize(indices.size());
+    FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+    memcpy(dataRtVal.getData(), &indices[0], sizeof(uint32_t) * indices.size());
+    m_binding.setArgValue("memberIndices", rtVal, false);
+    addRecordedInput("memberIndices");
+  }
+  if(exec.haveExecPort("memberWeights") &&
+    exec.getExecPortResolvedType("memberWeights") == std::string("Float32[]"))
+  {
+    FabricCore::RTVal rtVal = FabricSplice::constructVariableArrayRTVal("Float32");
+    rtVal.setArraySize(weights.size());
+    FabricCore::RTVal dataRtVal = rtVal.callMethod("Data", "data", 0, 0);
+    memcpy(dataRtVal.getData(), &weights[0], sizeof(float) * weights.size());
+    m_binding.setArgValue("memberWeights", rtVal, false);
+    addRecordedInput("memberWeights");
+  }
+}
+
 MStatus FabricDFGMayaDeformer::shouldSave(const MPlug &plug, bool &isSaving){
   // guarantee dynamically added attributes are saved
   isSaving = true;
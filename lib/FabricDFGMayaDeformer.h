@@ -12,6 +12,8 @@
 #include <maya/MNodeMessage.h>
 #include <maya/MStringArray.h>
 
+#include <vector>
+
 class FabricDFGMayaDeformer: public MPxDeformerNode, public FabricDFGBaseInterface{
 
 public:
@@ -57,4 +59,17 @@ private:
   int initializePolygonMeshPorts(MPlug &meshPlug, MDataBlock &data);
   // void initializeGeometry(MObject &meshObj);
   int mGeometryInitialized;
+
+  // the members of the deformer set with a non-zero weight: their
+  // point indices, their positions in the iteration, their weights and
+  // their positions (x, y, z, w). Reused from one deform to the next.
+  std::vector<unsigned int> mActiveIndices;
+  std::vector<unsigned int> mActiveMembers;
+  std::vector<float> mActiveWeights;
+  std::vector<double> mActivePoints;
+
+  // sets the optional memberIndices (UInt32[]) and memberWeights
+  // (Float32[]) ports to the members with a non-zero weight. Graphs
+  // with a memberIndices port only get the positions of these members.
+  void transferMembersToDFG(const std::vector<unsigned int> & indices, const std::vector<float> & weights);
 };
@@ -75,10 +75,21 @@ MStatus FabricDFGMayaNode::compute(const MPlug& plug, MDataBlock& data){
     //   return MStatus::kFailure; // avoid evaluating on errors
     // }
 
-    if(transferInputValuesToDFG(data))
+    // outputs which haven't been pulled by maya are left
+    // dirty and converted on their own compute, as long as
+    // the result of the last evaluation is still valid.
+    MString requestedPortName = getRequestedPortName(plug);
+    if(!getDFGExec().haveExecPort(requestedPortName.asChar()))
+      requestedPortName = "";
+
+    if(requestedPortName.length() > 0 && isEvaluationValid())
+    {
+      transferOutputValuesToMaya(data, false, requestedPortName);
+    }
+    else if(transferInputValuesToDFG(data))
     {
       evaluate();
-      transferOutputValuesToMaya(data);
+      transferOutputValuesToMaya(data, false, requestedPortName);
     }
 
     MAYADFG_CATCH_END(&stat);
@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#include "FabricDFGMemoryBudget.h"
+#include "FabricDFGBaseInterface.h"
+
+#include <maya/MTimerMessage.h>
+
+#include <stdlib.h>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+
+// how often the nodes are checked, in seconds
+#define FABRIC_MAYA_MEMORY_BUDGET_PERIOD 10.0f
+
+static MCallbackId s_timerCallbackId = 0;
+static double s_budgetBytes = 0.0;
+static double s_idleSeconds = 60.0;
+static unsigned int s_numReleased = 0;
+
+static bool isLessRecentlyEvaluated(FabricDFGBaseInterface * a, FabricDFGBaseInterface * b)
+{
+  return a->getLastEvalTime() < b->getLastEvalTime();
+}
+
+static void onTimer(float elapsedTime, float lastTime, void *clientData)
+{
+  FabricDFGMemoryBudget::enforce();
+}
+
+void FabricDFGMemoryBudget::initialize()
+{
+  const char * budget = getenv("FABRIC_MAYA_MEMORY_BUDGET_MB");
+  if(budget != NULL && atof(budget) > 0.0)
+    s_budgetBytes = atof(budget) * 1024.0 * 1024.0;
+
+  const char * idle = getenv("FABRIC_MAYA_IDLE_RELEASE_SECONDS");
+  if(idle != NULL && atof(idle) >= 0.0)
+    s_idleSeconds = atof(idle);
+
+  if(s_timerCallbackId != 0)
+    return;
+  s_timerCallbackId = MTimerMessage::addTimerCallback(FABRIC_MAYA_MEMORY_BUDGET_PERIOD, onTimer);
+}
+
+void FabricDFGMemoryBudget::shutdown()
+{
+  if(s_timerCallbackId != 0)
+    MTimerMessage::removeCallback(s_timerCallbackId);
+  s_timerCallbackId = 0;
+}
+
+void FabricDFGMemoryBudget::enforce()
+{
+  std::vector<FabricDFGBaseInterface*> instances = FabricDFGBaseInterface::getInstances();
+  if(instances.size() == 0)
+    return;
+
+  time_t now = time(NULL);
+  double totalBytes = 0.0;
+  std::vector<FabricDFGBaseInterface*> idleInstances;
+
+  for(size_t i=0;i<instances.size();i++)
+  {
+    FabricDFGBaseInterface * interf = instances[i];
+    if(interf->areArgValuesReleased())
+      continue;
+
+    // nodes which never evaluated have nothing to release
+    if(interf->getEvalCount() == 0)
+      continue;
+
+    if(interf->isNodeDisabled())
+    {
+      interf->releaseArgValues();
+      if(interf->areArgValuesReleased())
+        s_numReleased++;
+      continue;
+    }
+
+    if(s_budgetBytes <= 0.0)
+      continue;
+
+    totalBytes += interf->getArgMemoryEstimate();
+    if(difftime(now, interf->getLastEvalTime()) >= s_idleSeconds)
+      idleInstances.push_back(interf);
+  }
+
+  if(totalBytes <= s_budgetBytes)
+    return;
+
+  std::stable_sort(idleInstances.begin(), idleInstances.end(), isLessRecentlyEvaluated);
+  for(size_t i=0;i<idleInstances.size() && totalBytes > s_budgetBytes;i++)
+  {
+    FabricDFGBaseInterface * interf = idleInstances[i];
+    double bytes = interf->getArgMemoryEstimate();
+    interf->releaseArgValues();
+    if(!interf->areArgValuesReleased())
+      continue;
+    totalBytes -= bytes;
+    s_numReleased++;
+  }
+}
+
+unsigned int FabricDFGMemoryBudget::getNumReleased()
+{
+  return s_numReleased;
+}
@@ -0,0 +1,26 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#pragma once
+
+// Periodically releases the argument values of Canvas nodes which
+// don't need them: disabled nodes (nodeState HasNoEffect or Blocking)
+// are always released, idle nodes which haven't evaluated for
+// FABRIC_MAYA_IDLE_RELEASE_SECONDS (60 by default) are released, least
+// recently evaluated first, while the estimated argument memory of all
+// nodes is above FABRIC_MAYA_MEMORY_BUDGET_MB. Without a budget only the
+// disabled nodes are released. Released values are restored from the
+// Maya attributes on the next compute of the node.
+class FabricDFGMemoryBudget
+{
+public:
+
+  static void initialize();
+  static void shutdown();
+
+  // checks all of the nodes right away
+  static void enforce();
+
+  static unsigned int getNumReleased();
+};
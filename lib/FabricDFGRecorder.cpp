@@ -0,0 +1,172 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#include "FabricDFGRecorder.h"
+#include "FabricDFGRecording.h"
+#include "FabricDFGBaseInterface.h"
+#include "FabricSpliceHelpers.h"
+
+#include <maya/MAnimControl.h>
+#include <maya/MMutexLock.h>
+
+#include <stdlib.h>
+#include <set>
+#include <fstream>
+#include <algorithm>
+
+static std::ofstream s_stream;
+static MMutexLock s_streamLock;
+static bool s_recording = false;
+static bool s_playbackOnly = false;
+static MString s_filePath;
+static unsigned int s_numEvaluations = 0;
+static std::set<unsigned int> s_recordedBindings;
+
+void FabricDFGRecorder::initialize()
+{
+  const char * recordFile = getenv("FABRIC_MAYA_RECORD_FILE");
+  if(recordFile != NULL && recordFile[0] != '\0')
+    start(recordFile);
+}
+
+void FabricDFGRecorder::shutdown()
+{
+  stop();
+}
+
+bool FabricDFGRecorder::start(const MString & filePath, bool playbackOnly)
+{
+  stop();
+
+  s_streamLock.lock();
+  s_stream.open(filePath.asChar(), std::ios::out | std::ios::binary | std::ios::trunc);
+  bool opened = s_stream.is_open();
+  if(opened)
+  {
+    FabricDFGRecording::writeHeader(s_stream);
+    s_filePath = filePath;
+    s_playbackOnly = playbackOnly;
+    s_numEvaluations = 0;
+    s_recordedBindings.clear();
+    s_recording = true;
+  }
+  s_streamLock.unlock();
+
+  if(!opened)
+    mayaLogErrorFunc("FabricDFGRecorder: unable to write to '" + filePath + "'.");
+  return opened;
+}
+
+void FabricDFGRecorder::stop()
+{
+  s_streamLock.lock();
+  s_recording = false;
+  if(s_stream.is_open())
+    s_stream.close();
+  s_recordedBindings.clear();
+  s_streamLock.unlock();
+}
+
+bool FabricDFGRecorder::isRecording()
+{
+  return s_recording;
+}
+
+MString FabricDFGRecorder::getFilePath()
+{
+  return s_recording ? s_filePath : MString();
+}
+
+unsigned int FabricDFGRecorder::getNumEvaluations()
+{
+  return s_numEvaluations;
+}
+
+void FabricDFGRecorder::recordEvaluation(FabricDFGBaseInterface * interf, const std::vector<std::string> & transferredArgs)
+{
+  if(!s_recording)
+    return;
+  if(s_playbackOnly && !MAnimControl::isPlaying())
+  {
+    // the skipped inputs are missing from the stream,
+    // so the next recorded evaluation starts over
+    invalidateBinding(interf->getId());
+    return;
+  }
+
+  FabricCore::DFGBinding binding = interf->getDFGBinding();
+  if(!binding.isValid())
+    return;
+  unsigned int nodeId = interf->getId();
+
+  s_streamLock.lock();
+  bool recordBinding = s_recordedBindings.find(nodeId) == s_recordedBindings.end();
+  s_streamLock.unlock();
+
+  // the values are encoded outside of the lock,
+  // nodes may evaluate in parallel
+  FabricDFGRecording::Record bindingRecord;
+  FabricDFGRecording::Record evalRecord;
+  try
+  {
+    if(recordBinding)
+    {
+      bindingRecord.kind = FabricDFGRecording::RecordKind_Binding;
+      bindingRecord.nodeId = nodeId;
+      bindingRecord.nodeName = MFnDependencyNode(interf->getThisMObject()).name().asChar();
+      bindingRecord.json = binding.exportJSON().getCString();
+    }
+
+    evalRecord.kind = FabricDFGRecording::RecordKind_Evaluation;
+    evalRecord.nodeId = nodeId;
+    evalRecord.time = MAnimControl::currentTime().as(MTime::kSeconds);
+
+    // all of the inputs after the binding, then only the transferred ones
+    FabricCore::Client client = interf->getCoreClient();
+    FabricCore::DFGExec exec = binding.getExec();
+    for(unsigned int i=0;i<exec.getExecPortCount();i++)
+    {
+      if(exec.getExecPortType(i) == FabricCore::DFGPortType_Out)
+        continue;
+      char const * resolvedType = exec.getExecPortResolvedType(i);
+      if(!resolvedType)
+        continue; // [FE-5538]
+
+      std::string argName = exec.getExecPortName(i);
+      if(!recordBinding && std::find(transferredArgs.begin(), transferredArgs.end(), argName) == transferredArgs.end())
+        continue;
+
+      FabricDFGRecording::Arg arg;
+      if(FabricDFGRecording::encodeArg(client, argName, resolvedType, binding.getArgValue(argName.c_str()), arg))
+        evalRecord.args.push_back(arg);
+    }
+  }
+  catch(FabricCore::Exception e)
+  {
+    mayaLogErrorFunc(e.getDesc_cstr());
+    return;
+  }
+
+  s_streamLock.lock();
+  if(s_stream.is_open())
+  {
+    if(recordBinding)
+    {
+      FabricDFGRecording::writeRecord(s_stream, bindingRecord);
+      s_recordedBindings.insert(nodeId);
+    }
+    FabricDFGRecording::writeRecord(s_stream, evalRecord);
+    s_numEvaluations++;
+  }
+  s_streamLock.unlock();
+}
+
+void FabricDFGRecorder::invalidateBinding(unsigned int nodeId)
+{
+  if(!s_recording)
+    return;
+  s_streamLock.lock();
+  s_recordedBindings.erase(nodeId);
+  s_streamLock.unlock();
+}
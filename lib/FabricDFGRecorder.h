@@ -0,0 +1,41 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#pragma once
+
+#include <maya/MString.h>
+
+#include <string>
+#include <vector>
+
+class FabricDFGBaseInterface;
+
+// Records the evaluations of the Canvas nodes into a file, in the
+// format of FabricDFGRecording, so that they can be replayed without
+// Maya by the FabricCanvasReplay tool. The binding JSON of each node is
+// written on its first recorded evaluation (and again after its graph
+// changed), then the input values transferred from Maya for every
+// evaluation. Controlled by the FabricCanvasRecord command, or started
+// on load by setting FABRIC_MAYA_RECORD_FILE.
+class FabricDFGRecorder
+{
+public:
+
+  static void initialize();
+  static void shutdown();
+
+  // starts a new recording, replacing the file
+  static bool start(const MString & filePath, bool playbackOnly = false);
+  static void stop();
+  static bool isRecording();
+  static MString getFilePath();
+  static unsigned int getNumEvaluations();
+
+  // records the binding of the node if needed and the values of the
+  // inputs set since its last evaluation, called right before executing
+  static void recordEvaluation(FabricDFGBaseInterface * interf, const std::vector<std::string> & transferredArgs);
+
+  // the binding of the node is written again on its next evaluation
+  static void invalidateBinding(unsigned int nodeId);
+};
@@ -0,0 +1,339 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#include "FabricDFGRecording.h"
+
+#include <set>
+#include <stdio.h>
+#include <string.h>
+
+#define FABRIC_RECORDING_MAGIC "FCREC"
+#define FABRIC_RECORDING_VERSION 1
+
+namespace
+{
+  // the types whose arrays are recorded as raw memory
+  bool isShallowType(const std::string & type)
+  {
+    static std::set<std::string> types;
+    if(types.empty())
+    {
+      const char * names[] = {
+        "Boolean", "UInt8", "SInt8", "Byte", "UInt16", "SInt16",
+        "UInt32", "SInt32", "Integer", "Size", "Index", "Float32", "Scalar",
+        "UInt64", "SInt64", "Float64", "Vec2", "Vec3", "Vec4", "Color",
+        "RGB", "RGBA", "Quat", "Euler", "Mat22", "Mat33", "Mat44", "Xfo",
+        NULL
+      };
+      for(int i=0;names[i];i++)
+        types.insert(names[i]);
+    }
+    return types.find(type) != types.end();
+  }
+
+  void appendBytes(std::string & buffer, const void * data, size_t size)
+  {
+    if(size > 0)
+      buffer.append((const char *)data, size);
+  }
+
+  void appendUInt32(std::string & buffer, uint32_t value)
+  {
+    appendBytes(buffer, &value, sizeof(value));
+  }
+
+  // reads from a payload, fails with an exception once it is exhausted
+  struct PayloadReader
+  {
+    const std::string & payload;
+    size_t offset;
+
+    PayloadReader(const std::string & payload_)
+    : payload(payload_), offset(0)
+    {}
+
+    const char * read(size_t size)
+    {
+      if(offset + size > payload.size())
+        throw FabricCore::Exception("FabricDFGRecording: truncated value");
+      const char * data = payload.data() + offset;
+      offset += size;
+      return data;
+    }
+
+    uint32_t readUInt32()
+    {
+      uint32_t value;
+      memcpy(&value, read(sizeof(value)), sizeof(value));
+      return value;
+    }
+  };
+
+  void encodeMesh(FabricCore::Context const & context, FabricCore::RTVal mesh, std::string & payload)
+  {
+    if(!mesh.isValid() || mesh.isNullObject())
+    {
+      payload += '\0';
+      return;
+    }
+    payload += '\1';
+
+    uint32_t nbPoints   = (uint32_t)mesh.callMethod("UInt64", "pointCount",         0, 0).getUInt64();
+    uint32_t nbPolygons = (uint32_t)mesh.callMethod("UInt64", "polygonCount",       0, 0).getUInt64();
+    uint32_t nbSamples  = (uint32_t)mesh.callMethod("UInt64", "polygonPointsCount", 0, 0).getUInt64();
+    appendUInt32(payload, nbPoints);
+    appendUInt32(payload, nbPolygons);
+    appendUInt32(payload, nbSamples);
+
+    std::vector<double> points(nbPoints * 3);
+    if(nbPoints > 0)
+    {
+      std::vector<FabricCore::RTVal> args(2);
+      args[0] = FabricCore::RTVal::ConstructExternalArray(context, "Float64", points.size(), &points[0]);
+      args[1] = FabricCore::RTVal::ConstructUInt32(context, 3); // components
+      mesh.callMethod("", "getPointsAsExternalArray_d", 2, &args[0]);
+      appendBytes(payload, &points[0], points.size() * sizeof(double));
+    }
+
+    std::vector<uint32_t> counts(nbPolygons), indices(nbSamples);
+    if(nbPolygons > 0 && nbSamples > 0)
+    {
+      std::vector<FabricCore::RTVal> args(2);
+      args[0] = FabricCore::RTVal::ConstructExternalArray(context, "UInt32", counts.size(), &counts[0]);
+      args[1] = FabricCore::RTVal::ConstructExternalArray(context, "UInt32", indices.size(), &indices[0]);
+      mesh.callMethod("", "getTopologyAsCountsIndicesExternalArrays", 2, &args[0]);
+      appendBytes(payload, &counts[0], counts.size() * sizeof(uint32_t));
+      appendBytes(payload, &indices[0], indices.size() * sizeof(uint32_t));
+    }
+  }
+
+  FabricCore::RTVal decodeMesh(FabricCore::Context const & context, PayloadReader & reader)
+  {
+    FabricCore::RTVal mesh = FabricCore::RTVal::Create(context, "PolygonMesh", 0, 0);
+    if(*reader.read(1) == '\0')
+      return mesh;
+
+    uint32_t nbPoints   = reader.readUInt32();
+    uint32_t nbPolygons = reader.readUInt32();
+    uint32_t nbSamples  = reader.readUInt32();
+
+    if(nbPoints > 0)
+    {
+      // external arrays aren't const, so copy out of the payload
+      std::vector<double> points(nbPoints * 3);
+      memcpy(&points[0], reader.read(points.size() * sizeof(double)), points.size() * sizeof(double));
+
+      std::vector<FabricCore::RTVal> args(2);
+      args[0] = FabricCore::RTVal::ConstructExternalArray(context, "Float64", points.size(), &points[0]);
+      args[1] = FabricCore::RTVal::ConstructUInt32(context, 3); // components
+      mesh.callMethod("", "setPointsFromExternalArray_d", 2, &args[0]);
+    }
+
+    if(nbPolygons > 0 && nbSamples > 0)
+    {
+      std::vector<uint32_t> counts(nbPolygons), indices(nbSamples);
+      memcpy(&counts[0], reader.read(counts.size() * sizeof(uint32_t)), counts.size() * sizeof(uint32_t));
+      memcpy(&indices[0], reader.read(indices.size() * sizeof(uint32_t)), indices.size() * sizeof(uint32_t));
+
+      std::vector<FabricCore::RTVal> args(2);
+      args[0] = FabricCore::RTVal::ConstructExternalArray(context, "UInt32", counts.size(), &counts[0]);
+      args[1] = FabricCore::RTVal::ConstructExternalArray(context, "UInt32", indices.size(), &indices[0]);
+      mesh.callMethod("", "setTopologyFromCountsIndicesExternalArrays", 2, &args[0]);
+    }
+    return mesh;
+  }
+
+  void writeUInt32(std::ostream & stream, uint32_t value)
+  {
+    stream.write((const char *)&value, sizeof(value));
+  }
+
+  void writeString(std::ostream & stream, const std::string & value)
+  {
+    writeUInt32(stream, (uint32_t)value.size());
+    stream.write(value.data(), value.size());
+  }
+
+  bool readUInt32(std::istream & stream, uint32_t & value)
+  {
+    return !!stream.read((char *)&value, sizeof(value));
+  }
+
+  bool readString(std::istream & stream, std::string & value)
+  {
+    uint32_t size;
+    if(!readUInt32(stream, size))
+      return false;
+    value.resize(size);
+    if(size == 0)
+      return true;
+    return !!stream.read(&value[0], size);
+  }
+}
+
+void FabricDFGRecording::writeHeader(std::ostream & stream)
+{
+  stream.write(FABRIC_RECORDING_MAGIC, strlen(FABRIC_RECORDING_MAGIC));
+  writeUInt32(stream, FABRIC_RECORDING_VERSION);
+}
+
+bool FabricDFGRecording::readHeader(std::istream & stream)
+{
+  char magic[sizeof(FABRIC_RECORDING_MAGIC)] = {0};
+  if(!stream.read(magic, strlen(FABRIC_RECORDING_MAGIC)))
+    return false;
+  if(strcmp(magic, FABRIC_RECORDING_MAGIC) != 0)
+    return false;
+  uint32_t version;
+  if(!readUInt32(stream, version))
+    return false;
+  return version == FABRIC_RECORDING_VERSION;
+}
+
+void FabricDFGRecording::writeRecord(std::ostream & stream, const Record & record)
+{
+  stream.put((char)record.kind);
+  writeUInt32(stream, record.nodeId);
+
+  if(record.kind == RecordKind_Binding)
+  {
+    writeString(stream, record.nodeName);
+    writeString(stream, record.json);
+    return;
+  }
+
+  stream.write((const char *)&record.time, sizeof(record.time));
+  writeUInt32(stream, (uint32_t)record.args.size());
+  for(size_t i=0;i<record.args.size();i++)
+  {
+    const Arg & arg = record.args[i];
+    writeString(stream, arg.name);
+    writeString(stream, arg.type);
+    stream.put((char)arg.encoding);
+    writeUInt32(stream, arg.count);
+    writeString(stream, arg.payload);
+  }
+}
+
+bool FabricDFGRecording::readRecord(std::istream & stream, Record & record)
+{
+  int kind = stream.get();
+  if(kind != RecordKind_Binding && kind != RecordKind_Evaluation)
+    return false;
+  record.kind = (RecordKind)kind;
+  if(!readUInt32(stream, record.nodeId))
+    return false;
+
+  record.args.clear();
+  if(record.kind == RecordKind_Binding)
+    return readString(stream, record.nodeName) && readString(stream, record.json);
+
+  uint32_t numArgs;
+  if(!stream.read((char *)&record.time, sizeof(record.time)) || !readUInt32(stream, numArgs))
+    return false;
+  record.args.resize(numArgs);
+  for(uint32_t i=0;i<numArgs;i++)
+  {
+    Arg & arg = record.args[i];
+    if(!readString(stream, arg.name) || !readString(stream, arg.type))
+      return false;
+    int encoding = stream.get();
+    if(encoding == EOF)
+      return false;
+    arg.encoding = (uint8_t)encoding;
+    if(!readUInt32(stream, arg.count) || !readString(stream, arg.payload))
+      return false;
+  }
+  return true;
+}
+
+bool FabricDFGRecording::encodeArg(FabricCore::Context const & context, const std::string & name, const std::string & type, FabricCore::RTVal value, Arg & arg)
+{
+  if(!value.isValid())
+    return false;
+
+  arg.name = name;
+  arg.type = type;
+  arg.count = 0;
+  arg.payload.clear();
+
+  try
+  {
+    if(type == "PolygonMesh" || type == "PolygonMesh[]")
+    {
+      arg.encoding = ValueEncoding_PolygonMesh;
+      if(value.isArray())
+      {
+        arg.count = value.getArraySize();
+        for(uint32_t i=0;i<arg.count;i++)
+          encodeMesh(context, value.getArrayElement(i), arg.payload);
+      }
+      else
+      {
+        arg.count = 1;
+        encodeMesh(context, value, arg.payload);
+      }
+      return true;
+    }
+
+    size_t bracket = type.find('[');
+    if(value.isArray() && bracket != std::string::npos && type.substr(bracket) == "[]" && isShallowType(type.substr(0, bracket)))
+    {
+      arg.encoding = ValueEncoding_Raw;
+      arg.count = value.getArraySize();
+      if(arg.count > 0)
+      {
+        uint64_t dataSize = value.callMethod("UInt64", "dataSize", 0, 0).getUInt64();
+        FabricCore::RTVal dataRTVal = value.callMethod("Data", "data", 0, 0);
+        appendBytes(arg.payload, dataRTVal.getData(), (size_t)dataSize);
+      }
+      return true;
+    }
+
+    arg.encoding = ValueEncoding_JSON;
+    arg.payload = value.getJSON().getStringCString();
+    return true;
+  }
+  catch(FabricCore::Exception e)
+  {
+    // values without a JSON encoding aren't recorded
+  }
+  return false;
+}
+
+FabricCore::RTVal FabricDFGRecording::decodeArg(FabricCore::Context const & context, const Arg & arg)
+{
+  if(arg.encoding == ValueEncoding_PolygonMesh)
+  {
+    PayloadReader reader(arg.payload);
+    if(arg.type != "PolygonMesh[]")
+      return decodeMesh(context, reader);
+
+    FabricCore::RTVal meshes = FabricCore::RTVal::Construct(context, arg.type.c_str(), 0, 0);
+    meshes.setArraySize(arg.count);
+    for(uint32_t i=0;i<arg.count;i++)
+      meshes.setArrayElement(i, decodeMesh(context, reader));
+    return meshes;
+  }
+
+  FabricCore::RTVal value = FabricCore::RTVal::Construct(context, arg.type.c_str(), 0, 0);
+  if(arg.encoding == ValueEncoding_Raw)
+  {
+    value.setArraySize(arg.count);
+    if(arg.count > 0)
+    {
+      uint64_t dataSize = value.callMethod("UInt64", "dataSize", 0, 0).getUInt64();
+      if(dataSize != (uint64_t)arg.payload.size())
+        throw FabricCore::Exception("FabricDFGRecording: element size mismatch");
+      FabricCore::RTVal dataRTVal = value.callMethod("Data", "data", 0, 0);
+      memcpy(dataRTVal.getData(), arg.payload.data(), arg.payload.size());
+    }
+    return value;
+  }
+
+  if(arg.encoding != ValueEncoding_JSON)
+    throw FabricCore::Exception("FabricDFGRecording: unknown value encoding");
+  value.setJSON(arg.payload.c_str());
+  return value;
+}
@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#pragma once
+
+#include <FabricCore.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <iostream>
+
+// The binary stream written by FabricDFGRecorder and read by the
+// FabricCanvasReplay tool. Only depends on Fabric Core, so that the
+// recordings can be replayed without Maya.
+//
+// The stream starts with a header (magic and version) followed by
+// records. A binding record holds the JSON of a node's binding and is
+// written once per node, or again after the graph changed. An
+// evaluation record holds the scene time and the argument values set
+// on the binding before one execution; the first evaluation after a
+// binding record contains all of the inputs, the later ones only the
+// values which were transferred. Numbers are stored in the byte order
+// of the recording machine.
+class FabricDFGRecording
+{
+public:
+
+  enum RecordKind
+  {
+    RecordKind_Binding = 1,
+    RecordKind_Evaluation = 2
+  };
+
+  enum ValueEncoding
+  {
+    // the elements of an array of a shallow type, as is
+    ValueEncoding_Raw = 0,
+    // the JSON of the value
+    ValueEncoding_JSON = 1,
+    // points and topology of PolygonMesh and PolygonMesh[] values
+    ValueEncoding_PolygonMesh = 2
+  };
+
+  struct Arg
+  {
+    std::string name;
+    std::string type;
+    uint8_t encoding;
+    uint32_t count;
+    std::string payload;
+  };
+
+  struct Record
+  {
+    RecordKind kind;
+    uint32_t nodeId;
+    // binding records
+    std::string nodeName;
+    std::string json;
+    // evaluation records
+    double time;
+    std::vector<Arg> args;
+  };
+
+  static void writeHeader(std::ostream & stream);
+  static bool readHeader(std::istream & stream);
+  static void writeRecord(std::ostream & stream, const Record & record);
+  // returns false at the end of the stream or if it is truncated
+  static bool readRecord(std::istream & stream, Record & record);
+
+  // encodes the value of an argument, returns false if the
+  // value can't be recorded (for example objects without JSON)
+  static bool encodeArg(FabricCore::Context const & context, const std::string & name, const std::string & type, FabricCore::RTVal value, Arg & arg);
+  // constructs the value of a recorded argument, throws FabricCore::Exception
+  static FabricCore::RTVal decodeArg(FabricCore::Context const & context, const Arg & arg);
+};
@@ -11,6 +11,7 @@
 
 #include "FabricDFGWidget.h"
 #include "FabricDFGBaseInterface.h"
+#include "FabricDFGBindingCache.h"
 #include "FabricSpliceHelpers.h"
 
 #include <maya/MGlobal.h>
@@ -50,6 +51,8 @@ void FabricDFGWidget::Destroy()
   if ( s_widget )
     delete s_widget;
   s_widget = NULL;
+  // cached bindings belong to the client
+  FabricDFGBindingCache::clear();
   s_coreClient = FabricCore::Client();
 }
 
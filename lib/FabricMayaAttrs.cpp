@@ -79,10 +79,22 @@ DataType ParseDataType( FTL::StrRef dataTypeStr )
 
   else if ( dataTypeOverride == FTL_STR("Color"))           return DT_Color;
 
+  else if ( dataTypeOverride == FTL_STR("Vec2"))            return DT_Vec2;
+
+  else if ( dataTypeOverride == FTL_STR("Vec4"))            return DT_Vec4;
+
+  else if ( dataTypeOverride == FTL_STR("Quat"))            return DT_Quat;
+
+  else if ( dataTypeOverride == FTL_STR("Xfo"))             return DT_Xfo;
+
   else if ( dataTypeOverride == FTL_STR("PolygonMesh"))     return DT_PolygonMesh;
 
   else if ( dataTypeOverride == FTL_STR("Lines"))           return DT_Lines;
 
+  else if ( dataTypeOverride == FTL_STR("Curves"))          return DT_Curves;
+
+  else if ( dataTypeOverride == FTL_STR("Points"))          return DT_Points;
+
   else if ( dataTypeOverride == FTL_STR("KeyframeTrack"))   return DT_KeyframeTrack;
 
   else if ( dataTypeOverride == FTL_STR("SpliceMayaData"))  return DT_SpliceMayaData;
@@ -133,6 +145,8 @@ static void SetupMayaAttribute(
   {
     case DT_PolygonMesh:
     case DT_Lines:
+    case DT_Curves:
+    case DT_Points:
     case DT_SpliceMayaData:
       attr.setStorable( false );
       attr.setKeyable( false );
@@ -148,8 +162,9 @@ static void SetupMayaAttribute(
   {
     case AT_Single:
     case AT_Array_Native:
-      attr.setArray( false );
-      attr.setUsesArrayDataBuilder( false );
+      // a single Curves value holds one nurbsCurve per curve
+      attr.setArray( dataType == DT_Curves );
+      attr.setUsesArrayDataBuilder( dataType == DT_Curves );
       break;
 
     case AT_Array_Multi:
@@ -572,6 +587,66 @@ MObject CreateMayaAttribute(
     }
     break;
 
+    case DT_Vec2:
+    {
+      switch ( arrayType )
+      {
+        case AT_Single:
+        case AT_Array_Multi:
+        {
+          MFnNumericAttribute nAttrX;
+          MObject objX = nAttrX.create( name+"X", name+"X", MFnNumericData::kDouble );
+          SetupMayaAttribute(
+            nAttrX,
+            DT_Scalar,
+            FTL_STR("Float32"),
+            AT_Single,
+            FTL_STR("Single Value"),
+            isInput,
+            isOutput
+            );
+          MFnNumericAttribute nAttrY;
+          MObject objY = nAttrY.create( name+"Y", name+"Y", MFnNumericData::kDouble );
+          SetupMayaAttribute(
+            nAttrY,
+            DT_Scalar,
+            FTL_STR("Float32"),
+            AT_Single,
+            FTL_STR("Single Value"),
+            isInput,
+            isOutput
+            );
+          MFnNumericAttribute numAttr;
+          obj = numAttr.create(name, name, objX, objY);
+        }
+        break;
+
+        default: ThrowIncompatibleDataArrayTypes( dataTypeStr, arrayTypeStr );
+      }
+    }
+    break;
+
+    case DT_Vec4:
+    case DT_Quat:
+    {
+      switch ( arrayType )
+      {
+        case AT_Single:
+        case AT_Array_Multi:
+        {
+          MFnNumericAttribute numAttr;
+          obj = numAttr.create( name, name, MFnNumericData::k4Double );
+          if ( dataType == DT_Quat )
+            numAttr.setDefault( 0.0, 0.0, 0.0, 1.0 );
+        }
+        break;
+
+        default: ThrowIncompatibleDataArrayTypes( dataTypeStr, arrayTypeStr );
+      }
+    }
+    break;
+
+    case DT_Xfo:
     case DT_Mat44:
     {
       switch ( arrayType )
@@ -623,6 +698,39 @@ MObject CreateMayaAttribute(
     }
     break;
 
+    case DT_Curves:
+    {
+      switch ( arrayType )
+      {
+        case AT_Single:
+        {
+          MFnTypedAttribute tAttr;
+          obj = tAttr.create(name, name, MFnData::kNurbsCurve);
+        }
+        break;
+
+        default: ThrowIncompatibleDataArrayTypes( dataTypeStr, arrayTypeStr );
+      }
+    }
+    break;
+
+    case DT_Points:
+    {
+      switch ( arrayType )
+      {
+        case AT_Single:
+        case AT_Array_Multi:
+        {
+          MFnTypedAttribute tAttr;
+          obj = tAttr.create(name, name, MFnData::kDynArrayAttrs);
+        }
+        break;
+
+        default: ThrowIncompatibleDataArrayTypes( dataTypeStr, arrayTypeStr );
+      }
+    }
+    break;
+
     case DT_KeyframeTrack:
     {
       switch ( arrayType )
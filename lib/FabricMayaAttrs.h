@@ -20,8 +20,14 @@ enum DataType
   DT_Euler,
   DT_Mat44,
   DT_Color,
+  DT_Vec2,
+  DT_Vec4,
+  DT_Quat,
+  DT_Xfo,
   DT_PolygonMesh,
   DT_Lines,
+  DT_Curves,
+  DT_Points,
   DT_KeyframeTrack,
   DT_SpliceMayaData,
   DT_CompoundParam
@@ -0,0 +1,103 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#include "FabricMayaKernels.h"
+
+namespace FabricMaya {
+namespace Kernels {
+
+void MatricesToMat44(const double * src, float * dst, size_t count)
+{
+  for(size_t i=0;i<count;i++)
+  {
+    const double * m = src + i * 16;
+    float * d = dst + i * 16;
+    for(int row=0;row<4;row++)
+    {
+      d[row * 4 + 0] = (float)m[0 * 4 + row];
+      d[row * 4 + 1] = (float)m[1 * 4 + row];
+      d[row * 4 + 2] = (float)m[2 * 4 + row];
+      d[row * 4 + 3] = (float)m[3 * 4 + row];
+    }
+  }
+}
+
+void GatherVec3(const float * src, const int * indices, size_t count, float * dst)
+{
+  for(size_t i=0;i<count;i++)
+  {
+    const float * s = src + indices[i] * 3;
+    dst[i * 3 + 0] = s[0];
+    dst[i * 3 + 1] = s[1];
+    dst[i * 3 + 2] = s[2];
+  }
+}
+
+void GatherUVs(const float * u, const float * v, const int * indices, size_t count, float * dst)
+{
+  for(size_t i=0;i<count;i++)
+  {
+    dst[i * 2 + 0] = u[indices[i]];
+    dst[i * 2 + 1] = v[indices[i]];
+  }
+}
+
+void BuildFaceVertexIds(
+  const int * counts,
+  size_t numFaces,
+  const int * indices,
+  size_t numSamples,
+  int * faceIds,
+  int * vertexIds
+  )
+{
+  size_t sample = 0;
+  for(size_t face=0;face<numFaces && sample<numSamples;face++)
+  {
+    size_t end = sample + (size_t)counts[face];
+    if(end > numSamples)
+      end = numSamples;
+    for(;sample<end;sample++)
+    {
+      faceIds[sample] = (int)face;
+      vertexIds[sample] = indices[sample];
+    }
+  }
+}
+
+void PackPoints(const double * src, size_t count, double * dst)
+{
+  for(size_t i=0;i<count;i++)
+  {
+    dst[i * 3 + 0] = src[i * 4 + 0];
+    dst[i * 3 + 1] = src[i * 4 + 1];
+    dst[i * 3 + 2] = src[i * 4 + 2];
+  }
+}
+
+size_t PolylineSegmentCount(size_t numPoints, bool closed)
+{
+  if(numPoints == 0)
+    return 0;
+  return closed ? numPoints : numPoints - 1;
+}
+
+void BuildPolylineSegments(size_t numPoints, bool closed, uint32_t * indices)
+{
+  if(numPoints == 0)
+    return;
+  for(size_t i=0;i+1<numPoints;i++)
+  {
+    indices[i * 2 + 0] = (uint32_t)i;
+    indices[i * 2 + 1] = (uint32_t)(i + 1);
+  }
+  if(closed)
+  {
+    indices[(numPoints - 1) * 2 + 0] = (uint32_t)(numPoints - 1);
+    indices[(numPoints - 1) * 2 + 1] = 0;
+  }
+}
+
+} // namespace Kernels
+} // namespace FabricMaya
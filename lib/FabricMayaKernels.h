@@ -0,0 +1,47 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The buffer kernels of the Maya <-> KL conversions. They only work
+// on plain buffers and depend neither on Maya nor on Fabric, so they
+// can be built and measured on their own (see bench/).
+namespace FabricMaya {
+namespace Kernels {
+
+// converts row major double 4x4 matrices (the MMatrix layout) into
+// the float layout of KL's Mat44, which is transposed
+void MatricesToMat44(const double * src, float * dst, size_t count);
+
+// dst[i] = src[indices[i]] for 3 float components, used for
+// the face vertex normals of a mesh
+void GatherVec3(const float * src, const int * indices, size_t count, float * dst);
+
+// interleaves the indexed u and v values into uv pairs
+void GatherUVs(const float * u, const float * v, const int * indices, size_t count, float * dst);
+
+// builds the face and vertex id of every polygon sample from the
+// polygon counts and indices, as setFaceVertexNormals expects them
+void BuildFaceVertexIds(
+  const int * counts,
+  size_t numFaces,
+  const int * indices,
+  size_t numSamples,
+  int * faceIds,
+  int * vertexIds
+  );
+
+// drops the w of (x, y, z, w) points
+void PackPoints(const double * src, size_t count, double * dst);
+
+// the number of segments of a polyline through the given number of
+// points, and the start / end point indices of its segments
+size_t PolylineSegmentCount(size_t numPoints, bool closed);
+void BuildPolylineSegments(size_t numPoints, bool closed, uint32_t * indices);
+
+} // namespace Kernels
+} // namespace FabricMaya
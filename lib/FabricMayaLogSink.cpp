@@ -0,0 +1,406 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+#include <QtCore/QTimerEvent>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+
+#include "FabricMayaLogSink.h"
+#include <DFG/DFGLogWidget.h>
+
+#include <maya/MGlobal.h>
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <ctime>
+
+// capacity of the queue in distinct messages,
+// and the maximum number of lines written per flush
+#define FABRIC_LOGSINK_CAPACITY 1024
+#define FABRIC_LOGSINK_MAX_LINES_PER_FLUSH 100
+// the lines written for the same message within a window of
+// seconds, the further ones are summarized when it closes
+#define FABRIC_LOGSINK_RATE_WINDOW 5
+#define FABRIC_LOGSINK_RATE_MAX_LINES 3
+// the log file is flushed every so many lines
+#define FABRIC_LOGSINK_FILE_FLUSH_LINES 64
+
+namespace
+{
+  struct LogEntry
+  {
+    FabricMayaLogSink::Level level;
+    const char * prefix;
+    std::string message;
+    unsigned int count;
+    bool logToWidget;
+  };
+
+  typedef std::pair<int, std::string> LogKey;
+
+  struct RateLimit
+  {
+    LogEntry entry;
+    time_t windowStart;
+    unsigned int numWritten;
+    unsigned int numSuppressed;
+  };
+
+  class LogSinkFlushObject : public QObject
+  {
+  public:
+    bool event(QEvent *event);
+  protected:
+    void timerEvent(QTimerEvent *event);
+  };
+
+  static const QEvent::Type sFlushLogEventType = QEvent::Type(QEvent::registerEventType());
+
+  QMutex s_mutex;
+  LogEntry s_entries[FABRIC_LOGSINK_CAPACITY];
+  unsigned int s_numEntries = 0;
+  // index of the queued entries by level and message, for the dedupe
+  std::map<LogKey, unsigned int> s_entryIndex;
+  unsigned int s_numDropped = 0;
+  bool s_flushPosted = false;
+  LogSinkFlushObject * s_flushObject = NULL;
+  int s_summaryTimerId = 0;
+  std::ofstream s_logFile;
+  unsigned int s_numFileLines = 0;
+
+  // the open rate limit windows by level and message, they
+  // keep their counts across flushes
+  std::map<LogKey, RateLimit> s_rateLimits;
+  time_t s_lastWindowCheck = 0;
+
+  unsigned int s_numPosted = 0;
+  unsigned int s_numWritten = 0;
+  unsigned int s_numSuppressed = 0;
+
+  void writeLine(FabricMayaLogSink::Level level, const char * prefix, const MString & message, const MString & suffix, bool logToWidget)
+  {
+    if(level == FabricMayaLogSink::Level_Error)
+      MGlobal::displayError(MString(prefix)+message+suffix);
+    else
+      MGlobal::displayInfo(MString(prefix)+message+suffix);
+    if(logToWidget)
+      FabricUI::DFG::DFGLogWidget::log((message+suffix).asChar());
+  }
+
+  LogKey getLogKey(FabricMayaLogSink::Level level, const char * prefix, const std::string & message)
+  {
+    return LogKey((int)level, std::string(prefix) + message);
+  }
+
+  // takes the entry into its rate limit window, returns false if
+  // it is suppressed. Has to be called under s_mutex.
+  bool admitEntry(const LogEntry & entry, time_t now)
+  {
+    LogKey key = getLogKey(entry.level, entry.prefix, entry.message);
+    std::map<LogKey, RateLimit>::iterator it = s_rateLimits.find(key);
+    if(it == s_rateLimits.end())
+    {
+      RateLimit limit;
+      limit.entry = entry;
+      limit.windowStart = now;
+      limit.numWritten = 1;
+      limit.numSuppressed = 0;
+      s_rateLimits.insert(std::make_pair(key, limit));
+      return true;
+    }
+
+    RateLimit & limit = it->second;
+    if(limit.numWritten < FABRIC_LOGSINK_RATE_MAX_LINES)
+    {
+      limit.numWritten++;
+      return true;
+    }
+    limit.numSuppressed += entry.count;
+    s_numSuppressed += entry.count;
+    return false;
+  }
+
+  // closes the windows which are over, or all of them, and returns the
+  // summaries of their suppressed messages. Has to be called under s_mutex.
+  void closeRateLimitWindows(time_t now, bool all, std::vector<LogEntry> & summaries)
+  {
+    if(!all && now == s_lastWindowCheck)
+      return;
+    s_lastWindowCheck = now;
+
+    std::map<LogKey, RateLimit>::iterator it = s_rateLimits.begin();
+    while(it != s_rateLimits.end())
+    {
+      if(!all && difftime(now, it->second.windowStart) < FABRIC_LOGSINK_RATE_WINDOW)
+      {
+        it++;
+        continue;
+      }
+      if(it->second.numSuppressed > 0)
+      {
+        summaries.push_back(it->second.entry);
+        summaries.back().count = it->second.numSuppressed;
+      }
+      s_rateLimits.erase(it++);
+    }
+  }
+
+  bool haveSuppressedEntries()
+  {
+    std::map<LogKey, RateLimit>::const_iterator it = s_rateLimits.begin();
+    for(;it != s_rateLimits.end();it++)
+    {
+      if(it->second.numSuppressed > 0)
+        return true;
+    }
+    return false;
+  }
+
+  void writeSummaries(const std::vector<LogEntry> & summaries)
+  {
+    for(size_t i=0;i<summaries.size();i++)
+    {
+      MString countStr, windowStr;
+      countStr.set((int)summaries[i].count);
+      windowStr.set((int)FABRIC_LOGSINK_RATE_WINDOW);
+      MString suffix = " (repeated " + countStr + " more times in the last " + windowStr + " seconds)";
+      writeLine(summaries[i].level, summaries[i].prefix, summaries[i].message.c_str(), suffix, summaries[i].logToWidget);
+    }
+  }
+
+  // writes the line to the log file, which is flushed in batches.
+  // Has to be called under s_mutex.
+  void writeFileLine(FabricMayaLogSink::Level level, const char * prefix, const MString & message)
+  {
+    if(!s_logFile.is_open())
+      return;
+    s_logFile << (level == FabricMayaLogSink::Level_Error ? "Error: " : "") << prefix << message.asChar() << '\n';
+    if(++s_numFileLines >= FABRIC_LOGSINK_FILE_FLUSH_LINES)
+    {
+      s_logFile.flush();
+      s_numFileLines = 0;
+    }
+  }
+}
+
+bool LogSinkFlushObject::event(QEvent *event)
+{
+  if(event->type() == sFlushLogEventType)
+  {
+    FabricMayaLogSink::flush();
+    return true;
+  }
+  return QObject::event(event);
+}
+
+void LogSinkFlushObject::timerEvent(QTimerEvent *event)
+{
+  // closes the rate limit windows nobody posts to anymore
+  if(event->timerId() == s_summaryTimerId)
+    FabricMayaLogSink::flush();
+  else
+    QObject::timerEvent(event);
+}
+
+void FabricMayaLogSink::initialize()
+{
+  const char * logFile = getenv("FABRIC_MAYA_LOG_FILE");
+  if(logFile != NULL && logFile[0] != '\0')
+    setLogFile(logFile);
+
+  // in batch mode there is no event loop to flush on
+  if(MGlobal::mayaState() != MGlobal::kInteractive)
+    return;
+  if(QCoreApplication::instance() == NULL || s_flushObject != NULL)
+    return;
+  s_flushObject = new LogSinkFlushObject();
+}
+
+void FabricMayaLogSink::shutdown()
+{
+  flush();
+
+  std::vector<LogEntry> summaries;
+  {
+    QMutexLocker lock(&s_mutex);
+    closeRateLimitWindows(time(NULL), true, summaries);
+    s_numWritten += (unsigned int)summaries.size();
+  }
+  writeSummaries(summaries);
+
+  QMutexLocker lock(&s_mutex);
+  delete(s_flushObject);
+  s_flushObject = NULL;
+  s_summaryTimerId = 0;
+  s_flushPosted = false;
+  if(s_logFile.is_open())
+    s_logFile.close();
+  s_numFileLines = 0;
+}
+
+void FabricMayaLogSink::post(Level level, const char * prefix, const MString & message, bool logToWidget)
+{
+  QMutexLocker lock(&s_mutex);
+  s_numPosted++;
+
+  writeFileLine(level, prefix, message);
+
+  // without an event loop the rate limit is applied right away,
+  // the summaries are written once a later message closes the window
+  if(s_flushObject == NULL)
+  {
+    LogEntry entry;
+    entry.level = level;
+    entry.prefix = prefix;
+    entry.message = message.asChar();
+    entry.count = 1;
+    entry.logToWidget = logToWidget;
+
+    time_t now = time(NULL);
+    std::vector<LogEntry> summaries;
+    closeRateLimitWindows(now, false, summaries);
+    bool admitted = admitEntry(entry, now);
+    s_numWritten += (unsigned int)summaries.size() + (admitted ? 1 : 0);
+    lock.unlock();
+
+    writeSummaries(summaries);
+    if(admitted)
+      writeLine(level, prefix, message, "", logToWidget);
+    return;
+  }
+
+  LogKey key = getLogKey(level, prefix, message.asChar());
+  std::map<LogKey, unsigned int>::iterator it = s_entryIndex.find(key);
+  if(it != s_entryIndex.end())
+    s_entries[it->second].count++;
+  else if(s_numEntries == FABRIC_LOGSINK_CAPACITY)
+    s_numDropped++;
+  else
+  {
+    LogEntry & entry = s_entries[s_numEntries];
+    entry.level = level;
+    entry.prefix = prefix;
+    entry.message = message.asChar();
+    entry.count = 1;
+    entry.logToWidget = logToWidget;
+    s_entryIndex.insert(std::make_pair(key, s_numEntries));
+    s_numEntries++;
+  }
+
+  if(!s_flushPosted)
+  {
+    s_flushPosted = true;
+    QCoreApplication::postEvent(s_flushObject, new QEvent(sFlushLogEventType));
+  }
+}
+
+void FabricMayaLogSink::flush()
+{
+  // swap the queue out so that messages posted while
+  // writing to Maya end up in the next flush
+  std::vector<LogEntry> entries;
+  std::vector<LogEntry> summaries;
+  unsigned int numDropped = 0;
+  bool haveSuppressed = false;
+  {
+    QMutexLocker lock(&s_mutex);
+    time_t now = time(NULL);
+    closeRateLimitWindows(now, false, summaries);
+    s_numWritten += (unsigned int)summaries.size();
+
+    entries.reserve(s_numEntries);
+    for(unsigned int i=0;i<s_numEntries;i++)
+    {
+      if(admitEntry(s_entries[i], now))
+        entries.push_back(s_entries[i]);
+      s_entries[i].message.clear();
+    }
+    s_numEntries = 0;
+    s_entryIndex.clear();
+    numDropped = s_numDropped;
+    s_numDropped = 0;
+    s_flushPosted = false;
+    haveSuppressed = haveSuppressedEntries();
+
+    if(s_logFile.is_open())
+    {
+      s_logFile.flush();
+      s_numFileLines = 0;
+    }
+  }
+
+  // the open windows with suppressed messages
+  // are closed by a timer if nothing is posted
+  if(s_flushObject != NULL)
+  {
+    if(haveSuppressed && s_summaryTimerId == 0)
+      s_summaryTimerId = s_flushObject->startTimer(FABRIC_LOGSINK_RATE_WINDOW * 1000);
+    else if(!haveSuppressed && s_summaryTimerId != 0)
+    {
+      s_flushObject->killTimer(s_summaryTimerId);
+      s_summaryTimerId = 0;
+    }
+  }
+
+  writeSummaries(summaries);
+
+  unsigned int numSuppressed = numDropped;
+  for(size_t i=0;i<entries.size();i++)
+  {
+    if(i >= FABRIC_LOGSINK_MAX_LINES_PER_FLUSH)
+    {
+      numSuppressed += entries[i].count;
+      continue;
+    }
+
+    MString suffix;
+    if(entries[i].count > 1)
+    {
+      MString countStr;
+      countStr.set((int)entries[i].count);
+      suffix = " (repeated " + countStr + " times)";
+    }
+    writeLine(entries[i].level, entries[i].prefix, entries[i].message.c_str(), suffix, entries[i].logToWidget);
+    s_numWritten++;
+  }
+
+  if(numSuppressed > 0)
+  {
+    MString countStr;
+    countStr.set((int)numSuppressed);
+    MGlobal::displayWarning("[Splice] " + countStr + " further messages were suppressed.");
+    s_numSuppressed += numSuppressed;
+  }
+}
+
+bool FabricMayaLogSink::setLogFile(const MString & filePath)
+{
+  QMutexLocker lock(&s_mutex);
+  if(s_logFile.is_open())
+    s_logFile.close();
+  if(filePath.length() == 0)
+    return true;
+  s_logFile.open(filePath.asChar(), std::ios::out | std::ios::app);
+  return s_logFile.is_open();
+}
+
+unsigned int FabricMayaLogSink::getNumPosted()
+{
+  return s_numPosted;
+}
+
+unsigned int FabricMayaLogSink::getNumWritten()
+{
+  return s_numWritten;
+}
+
+unsigned int FabricMayaLogSink::getNumSuppressed()
+{
+  return s_numSuppressed;
+}
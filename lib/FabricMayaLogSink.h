@@ -0,0 +1,44 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#pragma once
+
+#include <maya/MString.h>
+
+// Collects the log, error and KL report messages from any thread and
+// writes them to Maya from the main thread once the event loop is idle.
+// Identical messages posted between two flushes are merged into a single
+// line with a repeat count, and a flush writes at most a fixed number of
+// lines, the remaining ones are summarized. Each message is also rate
+// limited to a few lines within a window of seconds, the repeats beyond
+// that are counted across flushes and summarized when the window closes.
+// In batch mode, or before initialize, there is no event loop: the
+// messages are rate limited and written right away.
+// All messages can additionally be written to a file, either through
+// setLogFile or the FABRIC_MAYA_LOG_FILE environment variable. The file
+// is flushed in batches of lines and on every flush.
+class FabricMayaLogSink
+{
+public:
+
+  enum Level
+  {
+    Level_Info,
+    Level_Error
+  };
+
+  static void initialize();
+  static void shutdown();
+
+  // the prefix is only used for the Maya output, the log widget
+  // receives the plain message. the prefix has to be a literal.
+  static void post(Level level, const char * prefix, const MString & message, bool logToWidget);
+  static void flush();
+
+  static bool setLogFile(const MString & filePath);
+
+  static unsigned int getNumPosted();
+  static unsigned int getNumWritten();
+  static unsigned int getNumSuppressed();
+};
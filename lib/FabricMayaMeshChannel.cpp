@@ -0,0 +1,218 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#include "FabricMayaMeshChannel.h"
+#include "FabricDFGBaseInterface.h"
+#include "FabricSpliceBaseInterface.h"
+
+#include <maya/MPlugArray.h>
+#include <maya/MFnAttribute.h>
+#include <maya/MFnTypedAttribute.h>
+#include <maya/MFnDependencyNode.h>
+#include <maya/MFnMesh.h>
+#include <maya/MFnMeshData.h>
+#include <maya/MPointArray.h>
+#include <maya/MIntArray.h>
+#include <maya/MMutexLock.h>
+
+#include <map>
+#include <string>
+
+namespace
+{
+  struct ChannelKey
+  {
+    unsigned int nodeHash;
+    std::string attributeName;
+    int index;
+
+    bool operator<(const ChannelKey & other) const
+    {
+      if(nodeHash != other.nodeHash)
+        return nodeHash < other.nodeHash;
+      if(index != other.index)
+        return index < other.index;
+      return attributeName < other.attributeName;
+    }
+  };
+
+  struct ChannelEntry
+  {
+    MObjectHandle node;
+    FabricCore::RTVal mesh;
+  };
+
+  // the hash codes of the nodes aren't unique, the
+  // entries of a key are told apart by their node
+  typedef std::multimap<ChannelKey, ChannelEntry> ChannelMap;
+}
+
+static ChannelMap s_entries;
+static MMutexLock s_entriesLock;
+static unsigned int s_numPublished = 0;
+static unsigned int s_numFetched = 0;
+
+static ChannelKey getChannelKey(const MPlug & plug)
+{
+  ChannelKey key;
+  key.nodeHash = MObjectHandle(plug.node()).hashCode();
+  key.attributeName = MFnAttribute(plug.attribute()).name().asChar();
+  key.index = plug.isElement() ? (int)plug.logicalIndex() : -1;
+  return key;
+}
+
+// the entry of the plug's node, has to be called under s_entriesLock
+static ChannelMap::iterator findEntry(const MPlug & plug)
+{
+  MObjectHandle node(plug.node());
+  std::pair<ChannelMap::iterator, ChannelMap::iterator> range = s_entries.equal_range(getChannelKey(plug));
+  for(ChannelMap::iterator it = range.first; it != range.second; it++)
+  {
+    if(it->second.node == node)
+      return it;
+  }
+  return s_entries.end();
+}
+
+bool FabricMayaMeshChannel::isFabricConsumer(const MPlug & dstPlug)
+{
+  // only the dynamic mesh attributes of the nodes are ports
+  MObject attribute = dstPlug.attribute();
+  if(!MFnAttribute(attribute).isDynamic())
+    return false;
+  if(!attribute.hasFn(MFn::kTypedAttribute))
+    return false;
+  if(MFnTypedAttribute(attribute).attrType() != MFnData::kMesh)
+    return false;
+
+  MObject node = dstPlug.node();
+  if(FabricDFGBaseInterface::getInstanceByMObject(node) != NULL)
+    return true;
+  return FabricSpliceBaseInterface::getInstanceByName(MFnDependencyNode(node).name().asChar()) != NULL;
+}
+
+bool FabricMayaMeshChannel::publish(const MPlug & srcPlug, FabricCore::RTVal mesh)
+{
+#if _SPLICE_MAYA_VERSION < 2015
+  // FE-5118, empty meshes crash Maya 2013 and 2014
+  return false;
+#else
+  if(!mesh.isValid() || mesh.isNullObject())
+    return false;
+
+  MPlugArray dstPlugs;
+  srcPlug.connectedTo(dstPlugs, false, true);
+  if(dstPlugs.length() == 0)
+    return false;
+  for(unsigned int i=0;i<dstPlugs.length();i++)
+  {
+    if(!isFabricConsumer(dstPlugs[i]))
+      return false;
+  }
+
+  ChannelEntry entry;
+  entry.node = MObjectHandle(srcPlug.node());
+  entry.mesh = mesh;
+
+  s_entriesLock.lock();
+  ChannelMap::iterator it = findEntry(srcPlug);
+  if(it != s_entries.end())
+    it->second = entry;
+  else
+    s_entries.insert(std::make_pair(getChannelKey(srcPlug), entry));
+  s_numPublished++;
+  s_entriesLock.unlock();
+  return true;
+#endif
+}
+
+void FabricMayaMeshChannel::withdraw(const MPlug & srcPlug)
+{
+  s_entriesLock.lock();
+  if(s_entries.size() > 0)
+  {
+    ChannelMap::iterator it = findEntry(srcPlug);
+    if(it != s_entries.end())
+      s_entries.erase(it);
+  }
+  s_entriesLock.unlock();
+}
+
+void FabricMayaMeshChannel::withdrawNode(const MObjectHandle & node)
+{
+  s_entriesLock.lock();
+  ChannelMap::iterator it = s_entries.begin();
+  while(it != s_entries.end())
+  {
+    // also drop the entries of nodes which are gone
+    if(it->second.node == node || !it->second.node.isValid())
+      s_entries.erase(it++);
+    else
+      it++;
+  }
+  s_entriesLock.unlock();
+}
+
+bool FabricMayaMeshChannel::isPublished(const MPlug & srcPlug)
+{
+  s_entriesLock.lock();
+  bool published = s_entries.size() > 0 && findEntry(srcPlug) != s_entries.end();
+  s_entriesLock.unlock();
+  return published;
+}
+
+bool FabricMayaMeshChannel::fetch(const MPlug & dstPlug, MDataHandle & handle, FabricCore::RTVal & mesh)
+{
+  s_entriesLock.lock();
+  bool empty = s_entries.size() == 0;
+  s_entriesLock.unlock();
+  if(empty)
+    return false;
+
+  MPlugArray srcPlugs;
+  dstPlug.connectedTo(srcPlugs, true, false);
+  if(srcPlugs.length() != 1)
+    return false;
+
+  // a mesh with vertices was converted by the source,
+  // the published entry is outdated in that case
+  MStatus meshStatus;
+  MFnMesh fnMesh(handle.asMesh(), &meshStatus);
+  if(meshStatus == MS::kSuccess && fnMesh.numVertices() > 0)
+    return false;
+
+  bool found = false;
+  s_entriesLock.lock();
+  ChannelMap::iterator it = findEntry(srcPlugs[0]);
+  if(it != s_entries.end())
+  {
+    mesh = it->second.mesh;
+    s_numFetched++;
+    found = true;
+  }
+  s_entriesLock.unlock();
+  return found;
+}
+
+MObject FabricMayaMeshChannel::createPlaceholderMesh()
+{
+  MFnMeshData meshDataFn;
+  MObject meshObject = meshDataFn.create();
+
+  MPointArray points;
+  MIntArray counts, indices;
+  MFnMesh mesh;
+  mesh.create(0, 0, points, counts, indices, meshObject);
+  return meshObject;
+}
+
+unsigned int FabricMayaMeshChannel::getNumPublished()
+{
+  return s_numPublished;
+}
+
+unsigned int FabricMayaMeshChannel::getNumFetched()
+{
+  return s_numFetched;
+}
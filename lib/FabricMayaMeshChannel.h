@@ -0,0 +1,45 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#pragma once
+
+#include <maya/MPlug.h>
+#include <maya/MObject.h>
+#include <maya/MObjectHandle.h>
+#include <maya/MDataHandle.h>
+
+#include <FabricCore.h>
+
+// Hands the PolygonMesh outputs of Canvas nodes directly to the Canvas
+// and Splice nodes reading them. If all of the destinations of an output
+// are Fabric node ports the RTVal is published here and an empty mesh is
+// set on the output instead of converting the mesh for Maya. The reading
+// node finds the RTVal through the source of its plug and uses it as is.
+// As soon as another consumer is connected the output is dirtied and
+// converted again. Must be used from the main thread or under the
+// evaluation of the nodes involved.
+class FabricMayaMeshChannel
+{
+public:
+
+  // publishes the mesh of the output plug if only Fabric
+  // nodes read it, returns false if it has to be converted
+  static bool publish(const MPlug & srcPlug, FabricCore::RTVal mesh);
+  static void withdraw(const MPlug & srcPlug);
+  static void withdrawNode(const MObjectHandle & node);
+  static bool isPublished(const MPlug & srcPlug);
+
+  // looks up the mesh published for the source of the destination
+  // plug, the handle has to be the empty mesh set by the source
+  static bool fetch(const MPlug & dstPlug, MDataHandle & handle, FabricCore::RTVal & mesh);
+
+  // true if the plug is a mesh port of a Canvas or Splice node
+  static bool isFabricConsumer(const MPlug & dstPlug);
+
+  // the empty mesh set on published outputs
+  static MObject createPlaceholderMesh();
+
+  static unsigned int getNumPublished();
+  static unsigned int getNumFetched();
+};
@@ -0,0 +1,190 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+#include <QtCore/QTime>
+#include <QtCore/QTimerEvent>
+#include <QtGui/QWidget>
+
+#include "FabricMayaRefreshScheduler.h"
+
+#include <maya/MGlobal.h>
+#include <maya/MMutexLock.h>
+
+#include <set>
+#include <stdlib.h>
+
+namespace
+{
+  class RefreshFlushObject : public QObject
+  {
+  public:
+    RefreshFlushObject() : timerId(0) {}
+    bool event(QEvent *event);
+    int timerId;
+  };
+
+  static const QEvent::Type sFlushRefreshEventType = QEvent::Type(QEvent::registerEventType());
+
+  RefreshFlushObject * s_flushObject = NULL;
+
+  // guards the pending requests, the refresh requests of KL
+  // (mayaRefreshFunc) can come from the evaluation threads
+  MMutexLock s_requestLock;
+  bool s_flushPosted = false;
+  bool s_refreshAll = false;
+  std::set<QWidget *> s_viewWidgets;
+  int s_minIntervalMs = 16;
+  QTime s_lastRefresh;
+
+  unsigned int s_numRequested = 0;
+  unsigned int s_numPerformed = 0;
+
+  // must be called with s_requestLock held
+  void scheduleFlush()
+  {
+    if(s_flushPosted)
+      return;
+    s_flushPosted = true;
+    QCoreApplication::postEvent(s_flushObject, new QEvent(sFlushRefreshEventType));
+  }
+}
+
+bool RefreshFlushObject::event(QEvent *event)
+{
+  if(event->type() == sFlushRefreshEventType || event->type() == QEvent::Timer)
+  {
+    if(event->type() == QEvent::Timer)
+    {
+      if(static_cast<QTimerEvent *>(event)->timerId() != timerId)
+        return QObject::event(event);
+      killTimer(timerId);
+      timerId = 0;
+    }
+
+    // respect the maximum refresh rate, the
+    // requests keep accumulating until then
+    if(s_lastRefresh.isValid())
+    {
+      int elapsed = s_lastRefresh.elapsed();
+      if(elapsed >= 0 && elapsed < s_minIntervalMs)
+      {
+        if(timerId == 0)
+          timerId = startTimer(s_minIntervalMs - elapsed);
+        return true;
+      }
+    }
+
+    FabricMayaRefreshScheduler::flush();
+    return true;
+  }
+  return QObject::event(event);
+}
+
+void FabricMayaRefreshScheduler::initialize()
+{
+  const char * maxRate = getenv("FABRIC_MAYA_MAX_REFRESH_RATE");
+  if(maxRate != NULL && atoi(maxRate) > 0)
+    s_minIntervalMs = 1000 / atoi(maxRate);
+
+  if(MGlobal::mayaState() != MGlobal::kInteractive)
+    return;
+  if(QCoreApplication::instance() == NULL || s_flushObject != NULL)
+    return;
+  s_flushObject = new RefreshFlushObject();
+}
+
+void FabricMayaRefreshScheduler::shutdown()
+{
+  s_requestLock.lock();
+  delete(s_flushObject);
+  s_flushObject = NULL;
+  s_flushPosted = false;
+  s_refreshAll = false;
+  s_viewWidgets.clear();
+  s_requestLock.unlock();
+}
+
+void FabricMayaRefreshScheduler::requestRefresh()
+{
+  s_requestLock.lock();
+  s_numRequested++;
+  bool scheduled = s_flushObject != NULL;
+  if(scheduled)
+  {
+    s_refreshAll = true;
+    s_viewWidgets.clear();
+    scheduleFlush();
+  }
+  s_requestLock.unlock();
+
+  if(!scheduled)
+    MGlobal::executeCommandOnIdle("refresh", false);
+}
+
+void FabricMayaRefreshScheduler::requestRefresh(M3dView & view)
+{
+  QWidget * widget = view.widget();
+
+  s_requestLock.lock();
+  s_numRequested++;
+  bool scheduled = s_flushObject != NULL;
+  if(scheduled)
+  {
+    if(!s_refreshAll)
+      s_viewWidgets.insert(widget);
+    scheduleFlush();
+  }
+  s_requestLock.unlock();
+
+  if(!scheduled)
+    view.refresh(true, true);
+}
+
+void FabricMayaRefreshScheduler::flush()
+{
+  // take the pending requests, the ones made
+  // while refreshing schedule another flush
+  s_requestLock.lock();
+  s_flushPosted = false;
+  bool refreshAll = s_refreshAll;
+  std::set<QWidget *> viewWidgets;
+  viewWidgets.swap(s_viewWidgets);
+  s_refreshAll = false;
+  s_requestLock.unlock();
+
+  if(!refreshAll && viewWidgets.size() == 0)
+    return;
+
+  if(refreshAll)
+  {
+    MGlobal::executeCommand("refresh", false, false);
+  }
+  else
+  {
+    // the views might have been closed since the request
+    for(unsigned int i=0;i<M3dView::numberOf3dViews();i++)
+    {
+      M3dView view;
+      if(M3dView::get3dView(i, view) != MS::kSuccess)
+        continue;
+      if(viewWidgets.find(view.widget()) != viewWidgets.end())
+        view.refresh(false, true);
+    }
+  }
+
+  s_lastRefresh.start();
+  s_numPerformed++;
+}
+
+unsigned int FabricMayaRefreshScheduler::getNumRequested()
+{
+  return s_numRequested;
+}
+
+unsigned int FabricMayaRefreshScheduler::getNumPerformed()
+{
+  return s_numPerformed;
+}
@@ -0,0 +1,31 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+#pragma once
+
+#include <maya/M3dView.h>
+
+// Collapses all of the viewport refresh requests issued within one
+// event loop iteration into a single refresh, which is performed once
+// the event loop is idle and no more often than the maximum refresh
+// rate (60 per second by default, FABRIC_MAYA_MAX_REFRESH_RATE).
+// Requests for a single view only refresh that view, unless a refresh
+// of all views is pending anyway. Requests can be made from any thread,
+// the refresh itself is performed on the main thread.
+class FabricMayaRefreshScheduler
+{
+public:
+
+  static void initialize();
+  static void shutdown();
+
+  static void requestRefresh();
+  static void requestRefresh(M3dView & view);
+
+  // performs the pending refresh right away
+  static void flush();
+
+  static unsigned int getNumRequested();
+  static unsigned int getNumPerformed();
+};
@@ -30,6 +30,7 @@
 #include <maya/MFileObject.h>
 #include <maya/MFnPluginData.h>
 #include <maya/MAnimControl.h>
+#include <maya/MTimer.h>
 
 #if _SPLICE_MAYA_VERSION >= 2016
 # include <maya/MEvaluationNode.h>
@@ -55,6 +56,9 @@ FabricSpliceBaseInterface::FabricSpliceBaseInterface(){
   _portObjectsDestroyed = false;
   _affectedPlugsDirty = true;
   _outputsDirtied = false;
+  _evalCount = 0;
+  _lastExecuteSeconds = 0.0;
+  _totalExecuteSeconds = 0.0;
 
   FabricSplice::setDCCOperatorSourceCodeCallback(&FabricSpliceEditorWidget::getSourceCodeForOperator);
 
@@ -234,7 +238,14 @@ void FabricSpliceBaseInterface::evaluate()
     }
   }
 
+  MTimer executeTimer;
+  executeTimer.beginTimer();
   _spliceGraph.evaluate();
+  executeTimer.endTimer();
+
+  _evalCount++;
+  _lastExecuteSeconds = executeTimer.elapsedTime();
+  _totalExecuteSeconds += _lastExecuteSeconds;
 }
 
 void FabricSpliceBaseInterface::transferOutputValuesToMaya(MDataBlock& data, bool isDeformer){
@@ -80,6 +80,12 @@ public:
 
   void managePortObjectValues(bool destroy);
 
+  // evaluation statistics, reported by the FabricCanvasStats command.
+  // the seconds only cover the evaluation of the graph
+  unsigned int getEvalCount() const { return _evalCount; }
+  double getLastExecuteSeconds() const { return _lastExecuteSeconds; }
+  double getTotalExecuteSeconds() const { return _totalExecuteSeconds; }
+
 protected:
   void invalidatePlug(MPlug & plug);
   virtual void invalidateNode();
@@ -103,6 +109,9 @@ protected:
   std::vector<std::string> mSpliceMayaDataOverride;
   bool _isTransferingInputs;
   bool _portObjectsDestroyed;
+  unsigned int _evalCount;
+  double _lastExecuteSeconds;
+  double _totalExecuteSeconds;
 
   bool transferInputValuesToSplice(MDataBlock& data);
   void evaluate();
@@ -5,6 +5,8 @@
 #include "FabricSpliceConversion.h"
 #include "FabricSpliceMayaData.h"
 #include "FabricSpliceHelpers.h"
+#include "FabricMayaMeshChannel.h"
+#include "FabricMayaKernels.h"
 
 #include <maya/MGlobal.h>
 #include <maya/MFnDependencyNode.h>
@@ -1095,6 +1097,7 @@ void plugToPort_mat44(MPlug &plug, MDataBlock &dataBlock, FabricSplice::DGPort &
 void plugToPort_PolygonMesh(MPlug &plug, MDataBlock &data, FabricSplice::DGPort & port, SpliceConversionTimers * timers){
 
   std::vector<MDataHandle> handles;
+  std::vector<MPlug> plugs;
   std::vector<FabricCore::RTVal> rtVals;
   FabricCore::RTVal portRTVal;
 
@@ -1112,6 +1115,7 @@ void plugToPort_PolygonMesh(MPlug &plug, MDataBlock &data, FabricSplice::DGPort
       for(unsigned int i = 0; i < elements; ++i){
         arrayHandle.jumpToArrayElement(i);
         handles.push_back(arrayHandle.inputValue());
+        plugs.push_back(plug.elementByLogicalIndex(arrayHandle.elementIndex()));
 
         FabricCore::RTVal polygonMesh;
         if(portRTVal.isArray())
@@ -1144,6 +1148,7 @@ void plugToPort_PolygonMesh(MPlug &plug, MDataBlock &data, FabricSplice::DGPort
     {
       timers->stop();
       handles.push_back(data.inputValue(plug));
+      plugs.push_back(plug);
       timers->resume();
 
       if(port.getMode() == FabricSplice::Port_Mode_IO)
@@ -1155,6 +1160,20 @@ void plugToPort_PolygonMesh(MPlug &plug, MDataBlock &data, FabricSplice::DGPort
 
     for(size_t handleIndex=0;handleIndex<handles.size();handleIndex++) 
     {
+      // meshes published by a Canvas node are used as they are,
+      // IO ports get a copy since they modify the mesh in place
+      FabricCore::RTVal sharedMesh;
+      if(FabricMayaMeshChannel::fetch(plugs[handleIndex], handles[handleIndex], sharedMesh))
+      {
+        if(port.getMode() == FabricSplice::Port_Mode_IO)
+          sharedMesh = sharedMesh.callMethod("PolygonMesh", "clone", 0, 0);
+        if(portRTVal.isArray())
+          portRTVal.setArrayElement(handleIndex, sharedMesh);
+        else
+          portRTVal = sharedMesh;
+        continue;
+      }
+
       MObject meshObj = handles[handleIndex].asMesh();
       MFnMesh mesh(meshObj);
       FabricCore::RTVal polygonMesh = rtVals[handleIndex];
@@ -1211,9 +1230,7 @@ void plugToPort_PolygonMesh(MPlug &plug, MDataBlock &data, FabricSplice::DGPort
         MFloatVectorArray values;
         values.setLength(mayaNormalsIds.length());
 
-        unsigned int offset = 0;
-        for(unsigned int i=0;i<mayaNormalsIds.length();i++)
-          values[offset++] = mayaNormals[mayaNormalsIds[i]];
+        FabricMaya::Kernels::GatherVec3(&mayaNormals[0].x, &mayaNormalsIds[0], mayaNormalsIds.length(), &values[0].x);
 
         std::vector<FabricCore::RTVal> args(1);
         args[0] = FabricSplice::constructExternalArrayRTVal("Float32", values.length() * 3, &values[0]);
@@ -1225,7 +1242,6 @@ void plugToPort_PolygonMesh(MPlug &plug, MDataBlock &data, FabricSplice::DGPort
       {
         MFloatArray u, v, values;
         mesh.getUVs(u, v);
-        unsigned int offset = 0;
 
         MIntArray counts, indices;
         mesh.getAssignedUVs(counts, indices);
@@ -1233,11 +1249,7 @@ void plugToPort_PolygonMesh(MPlug &plug, MDataBlock &data, FabricSplice::DGPort
         values.setLength(indices.length() * 2);
         if(values.length() > 0)
         {
-          for(unsigned int i=0;i<indices.length(); i++)
-          {
-            values[offset++] = u[indices[i]];
-            values[offset++] = v[indices[i]];
-          }
+          FabricMaya::Kernels::GatherUVs(&u[0], &v[0], &indices[0], indices.length(), &values[0]);
           u.clear();
           v.clear();
 
@@ -1346,32 +1358,17 @@ void plugToPort_Lines(MPlug &plug, MDataBlock &data, FabricSplice::DGPort & port
 
       MPointArray mayaPoints;
       curve.getCVs(mayaPoints);
-      std::vector<double> mayaDoubles(mayaPoints.length() * 3);
+      if(mayaPoints.length() == 0)
+        continue;
 
-      size_t nbSegments = (mayaPoints.length() - 1);
-      if(curve.form() == MFnNurbsCurve::kClosed)
-        nbSegments++;
+      std::vector<double> mayaDoubles(mayaPoints.length() * 3);
+      FabricMaya::Kernels::PackPoints(&mayaPoints[0].x, mayaPoints.length(), &mayaDoubles[0]);
 
+      bool closed = curve.form() == MFnNurbsCurve::kClosed;
+      size_t nbSegments = FabricMaya::Kernels::PolylineSegmentCount(mayaPoints.length(), closed);
       std::vector<uint32_t> mayaIndices(nbSegments * 2);
-
-      size_t voffset = 0;
-      size_t coffset = 0;
-      for(unsigned int i=0;i<mayaPoints.length();i++)
-      {
-        mayaDoubles[voffset++] = mayaPoints[i].x;
-        mayaDoubles[voffset++] = mayaPoints[i].y;
-        mayaDoubles[voffset++] = mayaPoints[i].z;
-        if(i < mayaPoints.length() - 1)
-        {
-          mayaIndices[coffset++] = i;
-          mayaIndices[coffset++] = i + 1;
-        }
-        else if(curve.form() == MFnNurbsCurve::kClosed)
-        {
-          mayaIndices[coffset++] = i;
-          mayaIndices[coffset++] = 0;
-        }
-      }
+      if(nbSegments > 0)
+        FabricMaya::Kernels::BuildPolylineSegments(mayaPoints.length(), closed, &mayaIndices[0]);
 
       FabricCore::RTVal mayaDoublesVal = FabricSplice::constructExternalArrayRTVal("Float64", mayaDoubles.size(), &mayaDoubles[0]);
       rtVal.callMethod("", "_setPositionsFromExternalArray_d", 1, &mayaDoublesVal);
@@ -2758,22 +2755,8 @@ void portToPlug_PolygonMesh_singleMesh(MDataHandle handle, FabricCore::RTVal rtM
   MIntArray normalFace, normalVertex;
   normalFace.setLength(mayaIndices.length());
   normalVertex.setLength(mayaIndices.length());        
-
-  int face = 0;
-  int vertex = 0;
-  int offset = 0;
-
-  for(unsigned int i=0;i<mayaIndices.length();i++) {
-    normalFace[i] = face;
-    normalVertex[i] = mayaIndices[offset + vertex];
-    vertex++;
-
-    if( vertex == mayaCounts[face] ) {
-      offset += mayaCounts[face];
-      face++;
-      vertex = 0;
-    }
-  }
+  if(mayaIndices.length() > 0)
+    FabricMaya::Kernels::BuildFaceVertexIds(&mayaCounts[0], mayaCounts.length(), &mayaIndices[0], mayaIndices.length(), &normalFace[0], &normalVertex[0]);
   
   mesh.create(mayaPoints.length(), mayaCounts.length(), mayaPoints, mayaCounts, mayaIndices, meshObject);  
   mesh.updateSurface();
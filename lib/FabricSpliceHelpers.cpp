@@ -4,6 +4,8 @@
 
 #include "FabricSpliceEditorWidget.h" // [pzion 20150519] Must come first because of some stupid macro definition somewhere
 #include "FabricSpliceHelpers.h"
+#include "FabricMayaLogSink.h"
+#include "FabricMayaRefreshScheduler.h"
 #include <DFG/DFGLogWidget.h>
 #include <DFG/DFGCombinedWidget.h>
 #include <Licensing/Licensing.h>
@@ -30,8 +32,7 @@ MString getModuleFolder()
 
 void mayaLogFunc(const MString & message)
 {
-  MGlobal::displayInfo(MString("[Splice] ")+message);
-  FabricUI::DFG::DFGLogWidget::log(message.asChar());
+  FabricMayaLogSink::post(FabricMayaLogSink::Level_Info, "[Splice] ", message, true);
 }
 
 void mayaLogFunc(const char * message, unsigned int length)
@@ -50,8 +51,7 @@ void mayaLogErrorFunc(const MString & message)
 {
   if(!gErrorEnabled)
     return;
-  MGlobal::displayError(MString("[Splice] ")+message);
-  FabricUI::DFG::DFGLogWidget::log(message.asChar());
+  FabricMayaLogSink::post(FabricMayaLogSink::Level_Error, "[Splice] ", message, true);
   gErrorOccured = true;
 }
 
@@ -76,7 +76,7 @@ MStatus mayaErrorOccured()
 
 void mayaKLReportFunc(const char * message, unsigned int length)
 {
-  MGlobal::displayInfo(MString("[KL]: ")+MString(message));
+  FabricMayaLogSink::post(FabricMayaLogSink::Level_Info, "[KL]: ", MString(message), false);
 }
 
 void mayaCompilerErrorFunc(unsigned int row, unsigned int col, const char * file, const char * level, const char * desc)
@@ -84,9 +84,8 @@ void mayaCompilerErrorFunc(unsigned int row, unsigned int col, const char * file
   MString line;
   line.set(row);
   MString composed = "[KL Compiler "+MString(level)+"]: line "+line+", op '"+MString(file)+"': "+MString(desc);
-  MGlobal::displayInfo(composed);
   FabricSpliceEditorWidget::reportAllCompilerError(row, col, file, level, desc);
-  FabricUI::DFG::DFGLogWidget::log(composed.asChar());
+  FabricMayaLogSink::post(FabricMayaLogSink::Level_Info, "", composed, true);
 }
 
 void mayaKLStatusFunc(const char * topicData, unsigned int topicLength,  const char * messageData, unsigned int messageLength)
@@ -124,7 +123,7 @@ void mayaKLStatusFunc(const char * topicData, unsigned int topicLength,  const c
 
 void mayaRefreshFunc()
 {
-  MGlobal::executeCommandOnIdle("refresh");
+  FabricMayaRefreshScheduler::requestRefresh();
 }
 
 void mayaSetLastLoadedScene(MString scene)
@@ -8,6 +8,7 @@
 #include <QtGui/QApplication>
 #include <QtGui/QScrollBar>
 #include <QtGui/QToolTip>
+#include <QtCore/QTimerEvent>
 
 #include "FabricSpliceKLSourceCodeWidget.h"
 #include "FabricSpliceHelpers.h"
@@ -211,6 +212,234 @@ std::string FabricSpliceCodeCompletionMenu::completionSuffix()
   return "";
 }
 
+static std::string getKLFunctionSignature(FabricSplice::KLParser::KLFunction f)
+{
+  std::string key = f.name();
+  key += "(";
+  FabricSplice::KLParser::KLArgumentList args = f.arguments();
+  for(unsigned k=0;k<args.nbArgs();k++)
+  {
+    if(k>0)
+      key += ", ";
+    key += args.mode(k);
+    key += " ";
+    key += args.type(k);
+    key += " ";
+    key += args.name(k);
+  }
+  key += ")";
+  return key;
+}
+
+void FabricSpliceKLSymbolIndex::addMethods(FabricSplice::KLParser p, std::vector<Entry> & methods)
+{
+  for(unsigned int j=0;j<p.getNbKLFunctions();j++)
+  {
+    FabricSplice::KLParser::KLFunction f = p.getKLFunction(j);
+    Entry entry;
+    entry.key = getKLFunctionSignature(f);
+    entry.name = f.name();
+    entry.comments = f.comments();
+    methods.push_back(entry);
+  }
+}
+
+void FabricSpliceKLSymbolIndex::Tables::clear()
+{
+  methodsByOwner.clear();
+  methodToolTips.clear();
+  membersByOwner.clear();
+  structs.clear();
+  globalsByName.clear();
+}
+
+void FabricSpliceKLSymbolIndex::Tables::add(FabricSplice::KLParser p)
+{
+  for(unsigned int j=0;j<p.getNbKLFunctions();j++)
+  {
+    FabricSplice::KLParser::KLFunction f = p.getKLFunction(j);
+    Entry entry;
+    entry.key = getKLFunctionSignature(f);
+    entry.name = f.name();
+    entry.comments = f.comments();
+
+    if(strlen(f.owner()) == 0)
+    {
+      globalsByName.insert(std::pair<std::string, Entry>(entry.name, entry));
+      continue;
+    }
+
+    methodsByOwner.insert(std::pair<std::string, Entry>(f.owner(), entry));
+
+    std::string toolTipText = f.comments();
+    toolTipText += "\n";
+    if(strlen(f.type()) > 0)
+    {
+      toolTipText += f.type();
+      toolTipText += " ";
+    }
+    toolTipText += f.owner();
+    toolTipText += ".";
+    toolTipText += entry.key;
+    methodToolTips.insert(std::pair<std::string, std::string>(std::string(f.owner()) + "." + entry.name, toolTipText));
+  }
+
+  for(unsigned int j=0;j<p.getNbKLStructs();j++)
+  {
+    FabricSplice::KLParser::KLStruct f = p.getKLStruct(j);
+    Entry entry;
+    entry.name = f.name();
+    entry.key = f.name();
+    if(strlen(f.type()) > 0)
+    {
+      entry.key += " (";
+      entry.key += f.type();
+      entry.key += ")";
+    }
+    structs.push_back(entry);
+
+    entry.key = f.name();
+    entry.key += " (";
+    entry.key += f.type();
+    entry.key += ")";
+    globalsByName.insert(std::pair<std::string, Entry>(entry.name, entry));
+
+    for(unsigned k=0;k<f.nbMembers();k++)
+    {
+      Entry member;
+      member.name = f.memberName(k);
+      member.key = member.name;
+      member.key += " (";
+      member.key += f.memberType(k);
+      member.key += ")";
+      membersByOwner.insert(std::pair<std::string, Entry>(entry.name, member));
+    }
+  }
+
+  for(unsigned int j=0;j<p.getNbKLConstants();j++)
+  {
+    FabricSplice::KLParser::KLConstant f = p.getKLConstant(j);
+    Entry entry;
+    entry.name = f.name();
+    entry.key = f.name();
+    entry.key += " = ";
+    entry.key += f.value();
+    globalsByName.insert(std::pair<std::string, Entry>(entry.name, entry));
+  }
+}
+
+void FabricSpliceKLSymbolIndex::rebuild(FabricSplice::KLParser localParser, const std::string & localName)
+{
+  // the operator's parser is registered with its name as extension
+  std::vector<std::string> extensionParsers;
+  for(unsigned int i=0;i<FabricSplice::KLParser::getNbParsers();i++)
+  {
+    FabricSplice::KLParser p = FabricSplice::KLParser::getParser(i);
+    std::string key = std::string(p.getExtension()) + "/" + p.getName();
+    if(key == localName + "/" + localName)
+      continue;
+    extensionParsers.push_back(key);
+  }
+
+  if(extensionParsers != mExtensionParsers)
+  {
+    mExtensionParsers = extensionParsers;
+    mExtensions.clear();
+    mArrayMethods.clear();
+    mDictMethods.clear();
+
+    addMethods(FabricSplice::KLParser::getParser("array", "array"), mArrayMethods);
+    addMethods(FabricSplice::KLParser::getParser("dict", "dict"), mDictMethods);
+
+    for(unsigned int i=0;i<FabricSplice::KLParser::getNbParsers();i++)
+    {
+      FabricSplice::KLParser p = FabricSplice::KLParser::getParser(i);
+      if(std::string(p.getExtension()) == localName && std::string(p.getName()) == localName)
+        continue;
+      mExtensions.add(p);
+    }
+  }
+
+  mLocal.clear();
+  mLocal.add(localParser);
+}
+
+std::string FabricSpliceKLSymbolIndex::getMethodToolTip(const std::string & owner, const std::string & name) const
+{
+  std::string toolTipText;
+  const Tables * tables[2] = { &mExtensions, &mLocal };
+  for(int t=0;t<2;t++)
+  {
+    std::pair<std::multimap<std::string, std::string>::const_iterator, std::multimap<std::string, std::string>::const_iterator> range =
+      tables[t]->methodToolTips.equal_range(owner + "." + name);
+    for(std::multimap<std::string, std::string>::const_iterator it = range.first;it!=range.second;it++)
+    {
+      if(toolTipText.length() > 0)
+        toolTipText += "\n";
+      toolTipText += it->second;
+    }
+  }
+  return toolTipText;
+}
+
+void FabricSpliceKLSymbolIndex::getMethods(const std::string & owner, std::map<std::string, Entry> & methods) const
+{
+  const Tables * tables[2] = { &mExtensions, &mLocal };
+  for(int t=0;t<2;t++)
+  {
+    std::pair<std::multimap<std::string, Entry>::const_iterator, std::multimap<std::string, Entry>::const_iterator> range =
+      tables[t]->methodsByOwner.equal_range(owner);
+    for(std::multimap<std::string, Entry>::const_iterator it = range.first;it!=range.second;it++)
+      methods.insert(std::pair<std::string, Entry>(it->second.key, it->second));
+  }
+}
+
+void FabricSpliceKLSymbolIndex::getMembers(const std::string & owner, std::map<std::string, std::string> & members) const
+{
+  const Tables * tables[2] = { &mExtensions, &mLocal };
+  for(int t=0;t<2;t++)
+  {
+    std::pair<std::multimap<std::string, Entry>::const_iterator, std::multimap<std::string, Entry>::const_iterator> range =
+      tables[t]->membersByOwner.equal_range(owner);
+    for(std::multimap<std::string, Entry>::const_iterator it = range.first;it!=range.second;it++)
+      members.insert(std::pair<std::string, std::string>(it->second.key, it->second.name));
+  }
+}
+
+void FabricSpliceKLSymbolIndex::getContainerMethods(bool isDict, std::map<std::string, Entry> & methods) const
+{
+  const std::vector<Entry> & entries = isDict ? mDictMethods : mArrayMethods;
+  for(size_t i=0;i<entries.size();i++)
+    methods.insert(std::pair<std::string, Entry>(entries[i].key, entries[i]));
+}
+
+void FabricSpliceKLSymbolIndex::getStructs(std::map<std::string, std::string> & matches) const
+{
+  const Tables * tables[2] = { &mExtensions, &mLocal };
+  for(int t=0;t<2;t++)
+  {
+    const std::vector<Entry> & structs = tables[t]->structs;
+    for(size_t i=0;i<structs.size();i++)
+      matches.insert(std::pair<std::string, std::string>(structs[i].key, structs[i].name));
+  }
+}
+
+void FabricSpliceKLSymbolIndex::getGlobals(const std::string & prefix, std::map<std::string, std::string> & matches) const
+{
+  const Tables * tables[2] = { &mExtensions, &mLocal };
+  for(int t=0;t<2;t++)
+  {
+    const std::multimap<std::string, Entry> & globals = tables[t]->globalsByName;
+    std::multimap<std::string, Entry>::const_iterator it = globals.lower_bound(prefix);
+    for(;it!=globals.end();it++)
+    {
+      if(it->first.compare(0, prefix.length(), prefix) != 0)
+        break;
+      matches.insert(std::pair<std::string, std::string>(it->second.key, it->second.name));
+    }
+  }
+}
+
 FabricSpliceKLPlainTextWidget::FabricSpliceKLPlainTextWidget(QFont font, FabricSpliceKLLineNumberWidget * lineNumbers, QWidget * parent)
 : QPlainTextEdit(parent)
 {
@@ -239,8 +468,11 @@ bool FabricSpliceKLPlainTextWidget::event(QEvent * e)
     QHelpEvent *helpEvent = static_cast<QHelpEvent *>(e);
     QTextCursor cursor = cursorForPosition(helpEvent->pos());
 
+    // tooltips only use the parse from the last pause in typing,
+    // the symbol positions are meaningless while the text is changing
     FabricSpliceKLSourceCodeWidget * sourceCodeWidget = (FabricSpliceKLSourceCodeWidget*)parent();
-    sourceCodeWidget->updateKLParser();
+    if(!sourceCodeWidget->isKLParserUpToDate())
+      return QPlainTextEdit::event(e);
     FabricSplice::KLParser parser = sourceCodeWidget->getKLParser();
     FabricSplice::KLParser::KLSymbol symbol = parser.getKLSymbolFromCharIndex(cursor.position());
     if(!symbol)
@@ -254,45 +486,7 @@ bool FabricSpliceKLPlainTextWidget::event(QEvent * e)
     {
       std::string name = symbol.str();
       std::string symbolType = parser.getKLTypeForSymbol(prevSymbol.prev());
-      for(unsigned int i=0;i<FabricSplice::KLParser::getNbParsers();i++)
-      {
-        FabricSplice::KLParser p = FabricSplice::KLParser::getParser(i);
-        for(unsigned int j=0;j<p.getNbKLFunctions();j++)
-        {
-          FabricSplice::KLParser::KLFunction f = p.getKLFunction(j);
-          if(f.owner() == symbolType && f.name() == name)
-          {
-            if(toolTipText.length() > 0)
-              toolTipText += "\n";
-            toolTipText += f.comments();
-            toolTipText += "\n";
-            if(strlen(f.type()) > 0)
-            {
-              toolTipText += f.type();
-              toolTipText += " ";
-            }
-            if(strlen(f.owner()) > 0)
-            {
-              toolTipText += f.owner();
-              toolTipText += ".";
-            }
-            toolTipText += f.name();
-            toolTipText += "(";
-            FabricSplice::KLParser::KLArgumentList args = f.arguments();
-            for(unsigned k=0;k<args.nbArgs();k++)
-            {
-              if(k>0)
-                toolTipText += ", ";
-              toolTipText += args.mode(k);
-              toolTipText += " ";
-              toolTipText += args.type(k);
-              toolTipText += " ";
-              toolTipText += args.name(k);
-            }
-            toolTipText += ")";
-          }
-        } 
-      }
+      toolTipText = sourceCodeWidget->getSymbolIndex().getMethodToolTip(symbolType, name);
     }
     else
     {
@@ -397,7 +591,9 @@ void FabricSpliceKLPlainTextWidget::keyPressEvent (QKeyEvent * e)
       {
         std::string prefix;
         FabricSpliceKLSourceCodeWidget * sourceCodeWidget = (FabricSpliceKLSourceCodeWidget*)parent();
-        sourceCodeWidget->updateKLParser();
+        if(!sourceCodeWidget->isKLParserUpToDate())
+          sourceCodeWidget->updateKLParser();
+        const FabricSpliceKLSymbolIndex & index = sourceCodeWidget->getSymbolIndex();
         FabricSplice::KLParser parser = sourceCodeWidget->getKLParser();
         FabricSplice::KLParser::KLSymbol symbol = parser.getKLSymbolFromCharIndex(textCursor().position());
         if(!symbol)
@@ -419,92 +615,15 @@ void FabricSpliceKLPlainTextWidget::keyPressEvent (QKeyEvent * e)
           if(symbolType.length() == 0)
             return;
 
-          std::map<std::string, FabricSplice::KLParser::KLFunction> methods;
+          std::map<std::string, FabricSpliceKLSymbolIndex::Entry> methods;
           std::map<std::string, std::string> members;
 
           if(symbolType.substr(symbolType.length()-1, 1) == "]")
-          {
-            FabricSplice::KLParser p;
-            if(symbolType.substr(symbolType.length()-2, 1) == "[")
-              p = FabricSplice::KLParser::getParser("array", "array");
-            else
-              p = FabricSplice::KLParser::getParser("dict", "dict");
-            for(unsigned int j=0;j<p.getNbKLFunctions();j++)
-            {
-              FabricSplice::KLParser::KLFunction f = p.getKLFunction(j);
-              std::string key = f.name();
-              // if(key[0] == '_')
-              //   continue;
-              key += "(";
-              FabricSplice::KLParser::KLArgumentList args = f.arguments();
-              for(unsigned k=0;k<args.nbArgs();k++)
-              {
-                if(k>0)
-                  key += ", ";
-                key += args.mode(k);
-                key += " ";
-                key += args.type(k);
-                key += " ";
-                key += args.name(k);
-              }
-              key += ")";
-              if(methods.find(key) != methods.end())
-                continue;
-              methods.insert(std::pair<std::string, FabricSplice::KLParser::KLFunction>(key, f));
-            } 
-          }
+            index.getContainerMethods(symbolType.substr(symbolType.length()-2, 1) != "[", methods);
           if(methods.size() == 0)
           {
-            for(unsigned int i=0;i<FabricSplice::KLParser::getNbParsers();i++)
-            {
-              FabricSplice::KLParser p = FabricSplice::KLParser::getParser(i);
-              for(unsigned int j=0;j<p.getNbKLFunctions();j++)
-              {
-                FabricSplice::KLParser::KLFunction f = p.getKLFunction(j);
-                if(f.owner() == symbolType)
-                {
-                  std::string key = f.name();
-                  // if(key[0] == '_')
-                  //   continue;
-                  key += "(";
-                  FabricSplice::KLParser::KLArgumentList args = f.arguments();
-                  for(unsigned k=0;k<args.nbArgs();k++)
-                  {
-                    if(k>0)
-                      key += ", ";
-                    key += args.mode(k);
-                    key += " ";
-                    key += args.type(k);
-                    key += " ";
-                    key += args.name(k);
-                  }
-                  key += ")";
-                  if(methods.find(key) != methods.end())
-                    continue;
-                  methods.insert(std::pair<std::string, FabricSplice::KLParser::KLFunction>(key, f));
-                }
-              } 
-              for(unsigned int j=0;j<p.getNbKLStructs();j++)
-              {
-                FabricSplice::KLParser::KLStruct f = p.getKLStruct(j);
-                if(f.name() == symbolType)
-                {
-                  for(unsigned k=0;k<f.nbMembers();k++)
-                  {
-                    std::string key = f.memberName(k);
-                    // if(key[0] == '_')
-                    //   continue;
-                    key += " (";
-                    key += f.memberType(k);
-                    key += ")";
-
-                    if(members.find(key) != members.end())
-                      continue;
-                    members.insert(std::pair<std::string, std::string>(key, f.memberName(k)));
-                  }
-                }
-              } 
-            }
+            index.getMethods(symbolType, methods);
+            index.getMembers(symbolType, members);
           }
 
           mCodeCompletionMenu->clearItems();
@@ -516,9 +635,9 @@ void FabricSpliceKLPlainTextWidget::keyPressEvent (QKeyEvent * e)
           {
             mCodeCompletionMenu->addItem(it->second, it->first, "");
           }
-          for(std::map<std::string, FabricSplice::KLParser::KLFunction>::iterator it = methods.begin();it!=methods.end();it++)
+          for(std::map<std::string, FabricSpliceKLSymbolIndex::Entry>::iterator it = methods.begin();it!=methods.end();it++)
           {
-            mCodeCompletionMenu->addItem(it->second.name(), it->first, it->second.comments());
+            mCodeCompletionMenu->addItem(it->second.name, it->first, it->second.comments);
           }
 
           QPoint pos = mapToGlobal(cursorRect().topLeft() + QPoint(0, font().pixelSize()));
@@ -531,24 +650,7 @@ void FabricSpliceKLPlainTextWidget::keyPressEvent (QKeyEvent * e)
         std::string name = symbol.str();
 
         std::map<std::string, std::string> matches;
-        for(unsigned int i=0;i<FabricSplice::KLParser::getNbParsers();i++)
-        {
-          FabricSplice::KLParser p = FabricSplice::KLParser::getParser(i);
-          for(unsigned int j=0;j<p.getNbKLStructs();j++)
-          {
-            FabricSplice::KLParser::KLStruct f = p.getKLStruct(j);
-            std::string key = f.name();
-            if(strlen(f.type()) > 0)
-            {
-              key += " (";
-              key += f.type();
-              key += ")";
-            }
-            if(matches.find(key) != matches.end())
-              continue;
-            matches.insert(std::pair<std::string, std::string>(key, f.name()));
-          } 
-        }
+        index.getStructs(matches);
         for(unsigned int j=0;j<parser.getNbKLVariables();j++)
         {
           FabricSplice::KLParser::KLVariable f = parser.getKLVariable(j);
@@ -567,70 +669,7 @@ void FabricSpliceKLPlainTextWidget::keyPressEvent (QKeyEvent * e)
           }
         }
 
-        for(unsigned int i=0;i<FabricSplice::KLParser::getNbParsers();i++)
-        {
-          FabricSplice::KLParser p = FabricSplice::KLParser::getParser(i);
-          for(unsigned int j=0;j<p.getNbKLConstants();j++)
-          {
-            FabricSplice::KLParser::KLConstant f = p.getKLConstant(j);
-            std::string match(f.name());
-            if(match.substr(0,name.length()) == name)
-            {
-              std::string key = f.name();
-              // if(key[0] == '_')
-              //   continue;
-              key += " = ";
-              key += f.value();
-              if(matches.find(key) != matches.end())
-                continue;
-              matches.insert(std::pair<std::string, std::string>(key, f.name()));
-            }
-          }
-          for(unsigned int j=0;j<p.getNbKLStructs();j++)
-          {
-            FabricSplice::KLParser::KLStruct f = p.getKLStruct(j);
-            std::string match(f.name());
-            if(match.substr(0,name.length()) == name)
-            {
-              std::string key = f.name();
-              // if(key[0] == '_')
-              //   continue;
-              key += " (";
-              key += f.type();
-              key += ")";
-              if(matches.find(key) != matches.end())
-                continue;
-              matches.insert(std::pair<std::string, std::string>(key, f.name()));
-            }
-          }           
-          for(unsigned int j=0;j<p.getNbKLFunctions();j++)
-          {
-            FabricSplice::KLParser::KLFunction f = p.getKLFunction(j);
-            std::string match(f.name());
-            if(strlen(f.owner()) == 0 && match.substr(0,name.length()) == name)
-            {
-              std::string key = f.name();
-              // if(key[0] == '_')
-              //   continue;
-              key += "(";
-              FabricSplice::KLParser::KLArgumentList args = f.arguments();
-              for(unsigned k=0;k<args.nbArgs();k++)
-              {
-                if(k>0)
-                  key += ", ";
-                key += args.mode(k);
-                key += " ";
-                key += args.type(k);
-                key += " ";
-                key += args.name(k);
-              }
-              key += ")";
-              if(matches.find(key) != matches.end())
-                continue;
-              matches.insert(std::pair<std::string, std::string>(key, f.name()));
-            }
-          } 
-        }
+        index.getGlobals(name, matches);
 
         mCodeCompletionMenu->clearItems();
         mCodeCompletionMenu->setPrefix(name);
@@ -680,6 +719,10 @@ FabricSpliceKLSourceCodeWidget::FabricSpliceKLSourceCodeWidget(QWidget * parent,
   layout()->addWidget(mLineNumbers);
   mTextEdit = new FabricSpliceKLPlainTextWidget(font, mLineNumbers, this);
   layout()->addWidget(mTextEdit);
+
+  mParsedRevision = -1;
+  mLastSeenRevision = -1;
+  mParseTimer.start(250, this);
 }
 
 std::string FabricSpliceKLSourceCodeWidget::getSourceCode()
@@ -699,7 +742,32 @@ void FabricSpliceKLSourceCodeWidget::setEnabled(bool enabled)
   mTextEdit->setEnabled(enabled);
 }
 
+bool FabricSpliceKLSourceCodeWidget::isKLParserUpToDate() const
+{
+  return mParsedRevision == mTextEdit->document()->revision();
+}
+
 void FabricSpliceKLSourceCodeWidget::updateKLParser()
 {
   mParser = FabricSplice::KLParser::getParser(mOperator.c_str(), mOperator.c_str(), getSourceCode().c_str());
+  mSymbolIndex.rebuild(mParser, mOperator);
+  mParsedRevision = mTextEdit->document()->revision();
+  mLastSeenRevision = mParsedRevision;
+}
+
+void FabricSpliceKLSourceCodeWidget::timerEvent(QTimerEvent * event)
+{
+  if(event->timerId() != mParseTimer.timerId())
+    return QWidget::timerEvent(event);
+
+  // only parse once the text didn't change for a full timer period
+  int revision = mTextEdit->document()->revision();
+  if(revision == mParsedRevision)
+    return;
+  if(revision != mLastSeenRevision)
+  {
+    mLastSeenRevision = revision;
+    return;
+  }
+  updateKLParser();
 }
@@ -11,10 +11,14 @@
 #include <QtGui/QFont>
 #include <QtGui/QFontMetrics>
 #include <QtGui/QMenu>
+#include <QtCore/QBasicTimer>
 
 #include "FabricSpliceKLSyntaxHighlighter.h"
 #include <FabricSplice.h>
 
+#include <map>
+#include <vector>
+
 class FabricSpliceKLLineNumberWidget : public QWidget {
 public:
   FabricSpliceKLLineNumberWidget(QFont font, QWidget * parent);
@@ -58,6 +62,51 @@ private:
   std::string mPressedKeySequence;
 };
 
+// sorted lookup tables over the functions, structs and constants of all
+// registered KL parsers, so that tooltips and code completion don't have
+// to walk all of the parsers. after each (debounced) parse only the
+// tables of the edited operator are rebuilt, the ones of the other
+// parsers (the extensions) only when the set of parsers changes.
+class FabricSpliceKLSymbolIndex {
+public:
+  struct Entry
+  {
+    std::string key;
+    std::string name;
+    std::string comments;
+  };
+
+  void rebuild(FabricSplice::KLParser localParser, const std::string & localName);
+
+  std::string getMethodToolTip(const std::string & owner, const std::string & name) const;
+  void getMethods(const std::string & owner, std::map<std::string, Entry> & methods) const;
+  void getMembers(const std::string & owner, std::map<std::string, std::string> & members) const;
+  void getContainerMethods(bool isDict, std::map<std::string, Entry> & methods) const;
+  void getStructs(std::map<std::string, std::string> & matches) const;
+  void getGlobals(const std::string & prefix, std::map<std::string, std::string> & matches) const;
+
+private:
+  struct Tables
+  {
+    std::multimap<std::string, Entry> methodsByOwner;
+    std::multimap<std::string, std::string> methodToolTips;
+    std::multimap<std::string, Entry> membersByOwner;
+    std::vector<Entry> structs;
+    std::multimap<std::string, Entry> globalsByName;
+
+    void clear();
+    void add(FabricSplice::KLParser p);
+  };
+
+  void addMethods(FabricSplice::KLParser p, std::vector<Entry> & methods);
+
+  Tables mExtensions;
+  Tables mLocal;
+  std::vector<std::string> mExtensionParsers;
+  std::vector<Entry> mArrayMethods;
+  std::vector<Entry> mDictMethods;
+};
+
 class FabricSpliceKLPlainTextWidget : public QPlainTextEdit {
 public:
   FabricSpliceKLPlainTextWidget(QFont font, FabricSpliceKLLineNumberWidget * lineNumbers, QWidget * parent);
@@ -84,11 +133,20 @@ public:
   void setSourceCode(const std::string & opName, const std::string & code);
   void setEnabled(bool enabled);
   FabricSplice::KLParser getKLParser() { return mParser; }
+  const FabricSpliceKLSymbolIndex & getSymbolIndex() const { return mSymbolIndex; }
+  bool isKLParserUpToDate() const;
   void updateKLParser();
 
+protected:
+  void timerEvent(QTimerEvent * event);
+
 private:
   FabricSpliceKLLineNumberWidget * mLineNumbers;
   FabricSpliceKLPlainTextWidget * mTextEdit;
   std::string mOperator;
   FabricSplice::KLParser mParser;
+  FabricSpliceKLSymbolIndex mSymbolIndex;
+  QBasicTimer mParseTimer;
+  int mParsedRevision;
+  int mLastSeenRevision;
 };
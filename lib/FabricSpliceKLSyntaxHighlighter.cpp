@@ -3,16 +3,10 @@
 //
 
 #include "FabricSpliceKLSyntaxHighlighter.h"
-#include "FabricSpliceButtonWidget.h"
-
-#include <maya/MGlobal.h>
 
 FabricSpliceKLSyntaxHighlighter::FabricSpliceKLSyntaxHighlighter(QTextDocument * document)
 : QSyntaxHighlighter(document)
 {
-
-  HighlightingRule rule;
-
   keywordFormat.setFontWeight(QFont::Bold);
   keywordFormat.setForeground(Qt::magenta);
   classFormat.setFontWeight(QFont::Bold);
@@ -21,200 +15,237 @@ FabricSpliceKLSyntaxHighlighter::FabricSpliceKLSyntaxHighlighter(QTextDocument *
   multiLineCommentFormat.setForeground(Qt::yellow);
   quotationFormat.setForeground(Qt::green);
 
+  QStringList keywordPatterns;
   keywordPatterns 
-    << "<<<"
-    << ">>>"
-    << "\\babs\\b"
-    << "\\bacos\\b"
-    << "\\basin\\b"
-    << "\\batan\\b"
-    << "\\bbreak\\b"
-    << "\\bconst\\b"
-    << "\\bcontinue\\b"
-    << "\\bcos\\b"
-    << "\\bcreateArrayGenerator\\b"
-    << "\\bcreateConstValue\\b"
-    << "\\bcreateReduce\\b"
-    << "\\bcreateValueGenerator\\b"
-    << "\\belse\\b"
-    << "\\bfor\\b"
-    << "\\bfunction\\b"
-    << "\\bif\\b"
-    << "\\bin\\b"
-    << "\\bio\\b"
-    << "\\boperator\\b"
-    << "\\breport\\b"
-    << "\\breturn\\b"
-    << "\\bsetError\\b"
-    << "\\bsin\\b"
-    << "\\bsqrt\\b"
-    << "\\bstruct\\b"
-    << "\\btan\\b"
-    << "\\btype\\b"
-    << "\\buse\\b"
-    << "\\brequire\\b"
-    << "\\bvar\\b"
-    << "\\btrue\\b"
-    << "\\bfalse\\b"
-    << "\\bValueProducer\\b"
-    << "\\bwhile\\b";
-
-  foreach (const QString &pattern, keywordPatterns) {
-    rule.pattern = QRegExp(pattern);
-    rule.format = keywordFormat;
-    highlightingRules.append(rule);
-  }
-
+    << "abs"
+    << "acos"
+    << "asin"
+    << "atan"
+    << "break"
+    << "const"
+    << "continue"
+    << "cos"
+    << "createArrayGenerator"
+    << "createConstValue"
+    << "createReduce"
+    << "createValueGenerator"
+    << "else"
+    << "for"
+    << "function"
+    << "if"
+    << "in"
+    << "io"
+    << "operator"
+    << "report"
+    << "return"
+    << "setError"
+    << "sin"
+    << "sqrt"
+    << "struct"
+    << "tan"
+    << "type"
+    << "use"
+    << "require"
+    << "var"
+    << "true"
+    << "false"
+    << "ValueProducer"
+    << "while";
+  foreach (const QString &pattern, keywordPatterns)
+    keywords.insert(pattern);
+
+  QStringList classPatterns;
   classPatterns 
-    << "\\bBoolean\\b"
-    << "\\bByte\\b"
-    << "\\bInteger\\b"
-    << "\\bSize\\b"
-    << "\\bIndex\\b"
-    << "\\bSInt32\\b"
-    << "\\bSInt64\\b"
-    << "\\bUInt64\\b"
-    << "\\bScalar\\b"
-    << "\\bFloat32\\b"
-    << "\\bFloat64\\b"
-    << "\\bString\\b"
-    << "\\bVec2\\b"
-    << "\\bVec3\\b"
-    << "\\bVec4\\b"
-    << "\\bQuat\\b"
-    << "\\bEuler\\b"
-    << "\\bRotationOrder\\b"
-    << "\\bMat22\\b"
-    << "\\bMat33\\b"
-    << "\\bMat44\\b"
-    << "\\bXfo\\b"
-    << "\\bMath\\b"
-    << "\\bColor\\b"
-    << "\\bRGB\\b"
-    << "\\bRGBA\\b"
-    << "\\bBoundingBox3\\b"
-    << "\\bRay\\b"
-    << "\\bKeyframe\\b"
-    << "\\bKeyframeTrack\\b"
-    << "\\bBezierXfo\\b"
-    << "\\bPoints\\b"
-    << "\\bLines\\b"
-    << "\\bPolygonMesh\\b"
-    << "\\bGeometryAttributes\\b"
-    << "\\bGeometryAttribute\\b"
-    << "\\bScalarAttribute\\b"
-    << "\\bVec2Attribute\\b"
-    << "\\bVec3Attribute\\b"
-    << "\\bVec4Attribute\\b"
-    << "\\bRGBAttribute\\b"
-    << "\\bRGBAAttribute\\b"
-    << "\\bColorAttribute\\b"
-    << "\\GeometryLocation\\b"
-    << "\\bDrawContext\\b"
-    << "\\bInlineDrawing\\b"
-    << "\\bInlineInstance\\b"
-    << "\\bInlineMaterial\\b"
-    << "\\bInlineShader\\b"
-    << "\\bInlineShape\\b"
-    << "\\bInlineTransform\\b"
-    << "\\bInlineUniform\\b"
-    << "\\bInlineTexture\\b"
-    << "\\bInlineFileBasedTexture\\b"
-    << "\\bInlineProceduralTexture\\b"
-    << "\\bInlineMatrixArrayTexture\\b"
-    << "\\bInlineDebugShape\\b"
-    << "\\bSimpleInlineInstance\\b"
-    << "\\bStaticInlineTransform\\b"
-    << "\\bInlineLinesShape\\b"
-    << "\\bInlineMeshShape\\b"
-    << "\\bOGLFlatShader\\b"
-    << "\\bOGLFlatVertexColorShader\\b"
-    << "\\bOGLFlatTextureShader\\b"
-    << "\\bOGLInlineDrawing\\b"
-    << "\\bOGLInlineShader\\b"
-    << "\\bOGLLinesShader\\b"
-    << "\\bOGLNormalShader\\b"
-    << "\\bOGLPointsShape\\b"
-    << "\\bOGLSurfaceVertexColorShader\\b"
-    << "\\bOGLSurfaceTextureShader\\b"
-    << "\\bOGLSurfaceNormalMapShader\\b";
-
-  foreach (const QString &pattern, classPatterns) {
-    rule.pattern = QRegExp(pattern);
-    rule.format = classFormat;
-    highlightingRules.append(rule);
-  }
-
-  rule.pattern = QRegExp("//[^\n]*");
-  rule.format = singleLineCommentFormat;
-  highlightingRules.append(rule);
-
-  rule.pattern = QRegExp("\\\"([^\\\"]|\\\\.)*\\\"");
-  rule.format = quotationFormat;
-  highlightingRules.append(rule);
-
-  rule.pattern = QRegExp("\\\'([^\\\']|\\\\.)*\\\'");
-  rule.format = quotationFormat;
-  highlightingRules.append(rule);
-
-  commentStartExpression = QRegExp("/\\*");
-  commentEndExpression = QRegExp("\\*/");
+    << "Boolean"
+    << "Byte"
+    << "Integer"
+    << "Size"
+    << "Index"
+    << "SInt32"
+    << "SInt64"
+    << "UInt64"
+    << "Scalar"
+    << "Float32"
+    << "Float64"
+    << "String"
+    << "Vec2"
+    << "Vec3"
+    << "Vec4"
+    << "Quat"
+    << "Euler"
+    << "RotationOrder"
+    << "Mat22"
+    << "Mat33"
+    << "Mat44"
+    << "Xfo"
+    << "Math"
+    << "Color"
+    << "RGB"
+    << "RGBA"
+    << "BoundingBox3"
+    << "Ray"
+    << "Keyframe"
+    << "KeyframeTrack"
+    << "BezierXfo"
+    << "Points"
+    << "Lines"
+    << "PolygonMesh"
+    << "GeometryAttributes"
+    << "GeometryAttribute"
+    << "ScalarAttribute"
+    << "Vec2Attribute"
+    << "Vec3Attribute"
+    << "Vec4Attribute"
+    << "RGBAttribute"
+    << "RGBAAttribute"
+    << "ColorAttribute"
+    << "GeometryLocation"
+    << "DrawContext"
+    << "InlineDrawing"
+    << "InlineInstance"
+    << "InlineMaterial"
+    << "InlineShader"
+    << "InlineShape"
+    << "InlineTransform"
+    << "InlineUniform"
+    << "InlineTexture"
+    << "InlineFileBasedTexture"
+    << "InlineProceduralTexture"
+    << "InlineMatrixArrayTexture"
+    << "InlineDebugShape"
+    << "SimpleInlineInstance"
+    << "StaticInlineTransform"
+    << "InlineLinesShape"
+    << "InlineMeshShape"
+    << "OGLFlatShader"
+    << "OGLFlatVertexColorShader"
+    << "OGLFlatTextureShader"
+    << "OGLInlineDrawing"
+    << "OGLInlineShader"
+    << "OGLLinesShader"
+    << "OGLNormalShader"
+    << "OGLPointsShape"
+    << "OGLSurfaceVertexColorShader"
+    << "OGLSurfaceTextureShader"
+    << "OGLSurfaceNormalMapShader";
+  foreach (const QString &pattern, classPatterns)
+    classes.insert(pattern);
 }
 
 bool FabricSpliceKLSyntaxHighlighter::isKeyWord(const QString & word)
 {
   if(word.length() == 0)
     return false;
-  QString pattern = "\\b";
-  pattern += word;
-  pattern += "\\b";
-  for(int i=0;i<keywordPatterns.length();i++)
-  {
-    if(keywordPatterns[i] == pattern)
-      return true;
-  }
-  for(int i=0;i<classPatterns.length();i++)
-  {
-    if(classPatterns[i] == pattern)
-      return true;
-  }
-  return false;
+  return keywords.contains(word) || classes.contains(word);
+}
+
+static inline bool isIdentifierStart(QChar c)
+{
+  return c.isLetter() || c == QChar('_');
+}
+
+static inline bool isIdentifierChar(QChar c)
+{
+  return c.isLetterOrNumber() || c == QChar('_');
 }
 
 void FabricSpliceKLSyntaxHighlighter::highlightBlock(const QString & text)
 {
-  foreach (const HighlightingRule &rule, highlightingRules)
+  // single pass over the block, the block state carries
+  // an open multi line comment over to the next block.
+  // QSyntaxHighlighter only calls this for the changed blocks
+  // and the following ones as long as their state changes.
+  const QChar * data = text.unicode();
+  int length = text.length();
+  int i = 0;
+
+  setCurrentBlockState(0);
+
+  if (previousBlockState() == 1)
   {
-    QRegExp expression(rule.pattern);
-    int index = expression.indexIn(text);
-    while (index >= 0)
+    int endIndex = text.indexOf(QLatin1String("*/"));
+    if (endIndex == -1)
     {
-      int length = expression.matchedLength();
-      setFormat(index, length, rule.format);
-      index = expression.indexIn(text, index + length);
+      setFormat(0, length, multiLineCommentFormat);
+      setCurrentBlockState(1);
+      return;
     }
+    i = endIndex + 2;
+    setFormat(0, i, multiLineCommentFormat);
   }
-  setCurrentBlockState(0);
 
-  int startIndex = 0;
-  if (previousBlockState() != 1)
-    startIndex = commentStartExpression.indexIn(text);
-
-  while (startIndex >= 0)
+  while (i < length)
   {
-    int endIndex = commentEndExpression.indexIn(text, startIndex);
-    int commentLength;
-    if (endIndex == -1)
+    QChar c = data[i];
+
+    if (c == QChar('/') && i + 1 < length)
     {
-      setCurrentBlockState(1);
-      commentLength = text.length() - startIndex;
+      if (data[i+1] == QChar('/'))
+      {
+        setFormat(i, length - i, singleLineCommentFormat);
+        return;
+      }
+      if (data[i+1] == QChar('*'))
+      {
+        int endIndex = text.indexOf(QLatin1String("*/"), i + 2);
+        if (endIndex == -1)
+        {
+          setFormat(i, length - i, multiLineCommentFormat);
+          setCurrentBlockState(1);
+          return;
+        }
+        setFormat(i, endIndex + 2 - i, multiLineCommentFormat);
+        i = endIndex + 2;
+        continue;
+      }
+    }
+
+    if (c == QChar('"') || c == QChar('\''))
+    {
+      int start = i++;
+      while (i < length && data[i] != c)
+      {
+        if (data[i] == QChar('\\'))
+          i++;
+        i++;
+      }
+      if (i < length)
+      {
+        i++;
+        setFormat(start, i - start, quotationFormat);
+      }
+      continue;
+    }
+
+    if ((c == QChar('<') || c == QChar('>')) && i + 2 < length
+      && data[i+1] == c && data[i+2] == c)
+    {
+      setFormat(i, 3, keywordFormat);
+      i += 3;
+      continue;
     }
-    else
+
+    if (isIdentifierStart(c))
     {
-      commentLength = endIndex - startIndex
-        + commentEndExpression.matchedLength();
+      int start = i++;
+      while (i < length && isIdentifierChar(data[i]))
+        i++;
+      QString word = QString::fromRawData(data + start, i - start);
+      if (keywords.contains(word))
+        setFormat(start, i - start, keywordFormat);
+      else if (classes.contains(word))
+        setFormat(start, i - start, classFormat);
+      continue;
     }
-    setFormat(startIndex, commentLength, multiLineCommentFormat);
-    startIndex = commentStartExpression.indexIn(text, startIndex + commentLength);
+
+    // skip the rest of numbers so that suffixes aren't taken as words
+    if (c.isDigit())
+    {
+      while (i < length && isIdentifierChar(data[i]))
+        i++;
+      continue;
+    }
+
+    i++;
   }
 }
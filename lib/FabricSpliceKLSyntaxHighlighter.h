@@ -5,12 +5,11 @@
 #pragma once
 
 #include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QtGui/QSyntaxHighlighter>
 #include <QtGui/QTextCharFormat>
 #include <QtGui/QTextDocument>
 
-#include <FabricCore.h>
-
 class FabricSpliceKLSyntaxHighlighter : public QSyntaxHighlighter {
 public:
 
@@ -21,17 +20,8 @@ protected:
   void highlightBlock(const QString &text);
 
 private:
-  struct HighlightingRule
-  {
-    QRegExp pattern;
-    QTextCharFormat format;
-  };
-  QVector<HighlightingRule> highlightingRules;
-
-  QRegExp commentStartExpression;
-  QRegExp commentEndExpression;
-  QStringList keywordPatterns;
-  QStringList classPatterns;
+  QSet<QString> keywords;
+  QSet<QString> classes;
 
   QTextCharFormat keywordFormat;
   QTextCharFormat classFormat;
@@ -2,6 +2,7 @@
 // Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
 //
 
+#include <QtCore/QCoreApplication>
 #include <QtGui/QWidget>
 #include <QtGui/QKeyEvent>
 #include <QtGui/QMouseEvent>
@@ -11,6 +12,7 @@
 #include "FabricSpliceBaseInterface.h"
 #include "FabricSpliceRenderCallback.h"
 #include "FabricSpliceHelpers.h"
+#include "FabricMayaRefreshScheduler.h"
 #include "FabricDFGBaseInterface.h"
 #include <FabricSplice.h>
 #include <maya/MCursor.h>
@@ -21,20 +23,27 @@
 #include <FTL/StrRef.h>
 
 #include <map>
+#include <memory>
 
 
 /////////////////////////////////////////////////////
 // FabricSpliceManipulationCmd
 
 FabricCore::RTVal FabricSpliceManipulationCmd::s_rtval_commands;
+MDGModifier * FabricSpliceManipulationCmd::s_dgModifier = NULL;
 
 FabricSpliceManipulationCmd::FabricSpliceManipulationCmd()
 {
   m_rtval_commands = s_rtval_commands;
+  m_dgModifier = s_dgModifier;
+  s_rtval_commands = FabricCore::RTVal();
+  s_dgModifier = NULL;
 }
 
 FabricSpliceManipulationCmd::~FabricSpliceManipulationCmd()
 {
+  if(m_dgModifier)
+    delete(m_dgModifier);
 }
 
 void* FabricSpliceManipulationCmd::creator()
@@ -56,8 +65,10 @@ MStatus FabricSpliceManipulationCmd::redoIt()
         m_rtval_commands.getArrayElement(i).callMethod("", "doAction", 0, 0);
       }
     }
+    if(m_dgModifier)
+      m_dgModifier->doIt();
     M3dView view = M3dView::active3dView();
-    view.refresh(true, true);
+    FabricMayaRefreshScheduler::requestRefresh(view);
     return MStatus::kSuccess;
   }
   catch (FabricCore::Exception e)
@@ -71,13 +82,15 @@ MStatus FabricSpliceManipulationCmd::undoIt()
 {
   try
   {
+    if(m_dgModifier)
+      m_dgModifier->undoIt();
     if(m_rtval_commands.isValid()){
       for(uint32_t i=0; i<m_rtval_commands.getArraySize(); i++){
         m_rtval_commands.getArrayElement(i).callMethod("", "undoAction", 0, 0);
       }
     }
     M3dView view = M3dView::active3dView();
-    view.refresh(true, true);
+    FabricMayaRefreshScheduler::requestRefresh(view);
     return MStatus::kSuccess;
   }
   catch (FabricCore::Exception e)
@@ -146,10 +159,19 @@ public:
 
 static EventFilterObject sEventFilterObject;
 
+// posted to the viewport widget to dispatch the coalesced mouse move
+static const QEvent::Type sFlushMouseMoveEventType = QEvent::Type(QEvent::registerEventType());
+
 const char helpString[] = "Click and drag to interact with Fabric:Splice.";
 
 FabricSpliceToolContext::FabricSpliceToolContext() 
+  : mMouseMovePending(false)
+  , mLastMouseMoveAccepted(false)
+  , mPendingMoveButton(Qt::NoButton)
+  , mPendingMoveButtons(Qt::NoButton)
+  , mPendingMoveModifiers(Qt::NoModifier)
 {
+  resetViewport();
 }
 
 void FabricSpliceToolContext::getClassName( MString & name ) const
@@ -176,7 +198,7 @@ void FabricSpliceToolContext::toolOnSetup(MEvent &)
 
       if(mEventDispatcher.isValid()){
         mEventDispatcher.callMethod("", "activateManipulation", 0, 0);
-        view.refresh(true, true);
+        FabricMayaRefreshScheduler::requestRefresh(view);
       }
     }
   }
@@ -189,6 +211,10 @@ void FabricSpliceToolContext::toolOnSetup(MEvent &)
     return;
   }
 
+  mMouseMovePending = false;
+  mLastMouseMoveAccepted = false;
+  resetViewport();
+
   sEventFilterObject.tool = this;
   view.widget()->installEventFilter(&sEventFilterObject);
   view.widget()->setFocus();
@@ -203,7 +229,7 @@ void FabricSpliceToolContext::toolOnSetup(MEvent &)
   setImage(imagePath, kImage2);
   setImage(imagePath, kImage3);
 
-  view.refresh(true, true);
+  FabricMayaRefreshScheduler::requestRefresh(view);
 }
 
 void FabricSpliceToolContext::toolOffCleanup()
@@ -219,12 +245,15 @@ void FabricSpliceToolContext::toolOffCleanup()
       // By deactivating the manipulation, we enable the manipulators to perform
       // cleanup, such as hiding paint brushes/gizmos. 
       mEventDispatcher.callMethod("", "deactivateManipulation", 0, 0);
-      view.refresh(true, true);
+      FabricMayaRefreshScheduler::requestRefresh(view);
 
       mEventDispatcher.invalidate();
     }
 
-    view.refresh(true, true);
+    mMouseMovePending = false;
+    resetViewport();
+
+    FabricMayaRefreshScheduler::requestRefresh(view);
   }
   catch (FabricCore::Exception e)
   {
@@ -265,17 +294,175 @@ void* FabricSpliceToolContextCmd::creator()
 
 bool EventFilterObject::eventFilter(QObject *object, QEvent *event)
 {
-  return tool->onEvent(event);
+  return tool->onEvent(object, event);
 }
 
 
 
-bool FabricSpliceToolContext::onEvent(QEvent *event)
+bool FabricSpliceToolContext::onEvent(QObject *object, QEvent *event)
 {
   if(!mEventDispatcher.isValid()){
     mayaLogFunc("Fabric Client not constructed yet.");
     return false;
   }
+
+  if(event->type() == sFlushMouseMoveEventType)
+  {
+    flushPendingMouseMove();
+    return true;
+  }
+
+  // Mouse moves arrive a lot faster than we can dispatch and redraw,
+  // so we only keep the latest one and dispatch it once all queued
+  // events have been processed. The result of the last dispatched
+  // move is used so that maya keeps handling the moves we don't.
+  if(event->type() == QEvent::MouseMove)
+  {
+    QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
+    mPendingMovePos = mouseEvent->pos();
+    mPendingMoveButton = mouseEvent->button();
+    mPendingMoveButtons = mouseEvent->buttons();
+    mPendingMoveModifiers = mouseEvent->modifiers();
+    if(!mMouseMovePending)
+    {
+      mMouseMovePending = true;
+      // posted to the widget the move came from, the
+      // active view might change before it is processed
+      QCoreApplication::postEvent(object, new QEvent(sFlushMouseMoveEventType));
+    }
+    if(mLastMouseMoveAccepted)
+      event->accept();
+    return mLastMouseMoveAccepted;
+  }
+
+  // keep the order of events, a press or release
+  // has to see the latest position first
+  flushPendingMouseMove();
+  return dispatchEvent(event);
+}
+
+void FabricSpliceToolContext::flushPendingMouseMove()
+{
+  if(!mMouseMovePending)
+    return;
+  mMouseMovePending = false;
+
+  QMouseEvent mouseEvent(QEvent::MouseMove, mPendingMovePos, mPendingMoveButton, mPendingMoveButtons, mPendingMoveModifiers);
+  mLastMouseMoveAccepted = dispatchEvent(&mouseEvent);
+}
+
+void FabricSpliceToolContext::resetViewport()
+{
+  mDrawContext.invalidate();
+  mInlineViewport.invalidate();
+  mInlineCamera.invalidate();
+  mPortWidth = -1.0;
+  mPortHeight = -1.0;
+  mCameraMatrix = MMatrix();
+  mCameraIsOrtho = false;
+  mCameraFrustum = -1.0;
+  mCameraNear = -1.0;
+  mCameraFar = -1.0;
+}
+
+void FabricSpliceToolContext::updateViewport(M3dView &view)
+{
+  if(!mInlineViewport.isValid())
+  {
+    mInlineViewport = FabricSplice::constructObjectRTVal("InlineViewport");
+    mInlineCamera = FabricSplice::constructObjectRTVal("InlineCamera");
+    // Note: There is a task open to unify the viewports between rendering and manipulation
+    // This will mean that resize can occur against the propper draw context. 
+    // Here I create a temporary DrawContext, but that should be eliminated.
+    mDrawContext = FabricSplice::constructObjectRTVal("DrawContext");
+    mDrawContext.setMember("viewport", mInlineViewport);
+    mInlineViewport.callMethod("", "setCamera", 1, &mInlineCamera);
+  }
+
+  double width = view.portWidth();
+  double height = view.portHeight();
+  if(width != mPortWidth || height != mPortHeight)
+  {
+    std::vector<FabricCore::RTVal> args(3);
+    args[0] = mDrawContext;
+    args[1] = FabricSplice::constructFloat64RTVal(width);
+    args[2] = FabricSplice::constructFloat64RTVal(height);
+    mInlineViewport.callMethod("", "resize", 3, &args[0]);
+  }
+
+  //////////////////////////
+  // Setup the Camera
+  MDagPath cameraDag;
+  view.getCamera(cameraDag);
+  MFnCamera camera(cameraDag);
+
+  bool isOrthographic = camera.isOrtho();
+  double frustum = 0.0;
+  if(isOrthographic){
+    double windowAspect = width/height;
+    double left = 0.0;
+    double right = 0.0;
+    double bottom = 0.0;
+    double top = 0.0;
+    bool  applyOverscan = 0.0;
+    bool  applySqueeze = 0.0;
+    bool  applyPanZoom = 0.0;
+    camera.getViewingFrustum ( windowAspect, left, right, bottom, top, applyOverscan, applySqueeze, applyPanZoom );
+    frustum = top-bottom;
+  }
+  else{
+    double fovX, fovY;
+    camera.getPortFieldOfView(view.portWidth(), view.portHeight(), fovX, fovY);    
+    frustum = fovY;
+  }
+
+  FabricCore::RTVal param;
+  if(isOrthographic != mCameraIsOrtho || frustum != mCameraFrustum || width != mPortWidth || height != mPortHeight)
+  {
+    param = FabricSplice::constructBooleanRTVal(isOrthographic);
+    mInlineCamera.callMethod("", "setOrthographic", 1, &param);
+    param = FabricSplice::constructFloat64RTVal(frustum);
+    if(isOrthographic)
+      mInlineCamera.callMethod("", "setOrthographicFrustumHeight", 1, &param);
+    else
+      mInlineCamera.callMethod("", "setFovY", 1, &param);
+    mCameraIsOrtho = isOrthographic;
+    mCameraFrustum = frustum;
+  }
+
+  double nearDistance = camera.nearClippingPlane();
+  double farDistance = camera.farClippingPlane();
+  if(nearDistance != mCameraNear || farDistance != mCameraFar)
+  {
+    param = FabricSplice::constructFloat64RTVal(nearDistance);
+    mInlineCamera.callMethod("", "setNearDistance", 1, &param);
+    param = FabricSplice::constructFloat64RTVal(farDistance);
+    mInlineCamera.callMethod("", "setFarDistance", 1, &param);
+    mCameraNear = nearDistance;
+    mCameraFar = farDistance;
+  }
+
+  MMatrix mayaCameraMatrix = cameraDag.inclusiveMatrix();
+  if(mayaCameraMatrix != mCameraMatrix)
+  {
+    FabricCore::RTVal cameraMat = FabricSplice::constructRTVal("Mat44");
+    FabricCore::RTVal cameraMatData = cameraMat.callMethod("Data", "data", 0, 0);
+    float * cameraMatFloats = (float*)cameraMatData.getData();
+    if(cameraMatFloats) {
+      for(unsigned int i=0;i<4;i++)
+        for(unsigned int j=0;j<4;j++)
+          cameraMatFloats[i*4+j] = (float)mayaCameraMatrix[j][i];
+      mInlineCamera.callMethod("", "setFromMat44", 1, &cameraMat);
+    }
+    mCameraMatrix = mayaCameraMatrix;
+  }
+
+  mPortWidth = width;
+  mPortHeight = height;
+}
+
+bool FabricSpliceToolContext::dispatchEvent(QEvent *event)
+{
   // Now we translate the Qt events to FabricEngine events..
 
   try
@@ -337,88 +524,7 @@ bool FabricSpliceToolContext::onEvent(QEvent *event)
 
       //////////////////////////
       // Setup the viewport
-      FabricCore::RTVal inlineViewport = FabricSplice::constructObjectRTVal("InlineViewport");
-      {
-        double width = view.portWidth();
-        double height = view.portHeight();
-        // Note: There is a task open to unify the viewports between rendering and manipulation
-        // This will mean that resize can occur against the propper draw context. 
-        // Here I create a temporary DrawContext, but that should be eliminated.
-        FabricCore::RTVal drawContext = FabricSplice::constructObjectRTVal("DrawContext");
-        drawContext.setMember("viewport", inlineViewport);
-        std::vector<FabricCore::RTVal> args(3);
-        args[0] = drawContext;
-        args[1] = FabricSplice::constructFloat64RTVal(width);
-        args[2] = FabricSplice::constructFloat64RTVal(height);
-        inlineViewport.callMethod("", "resize", 3, &args[0]);
-
-        //////////////////////////
-        // Setup the Camera
-        {
-          FabricCore::RTVal inlineCamera = FabricSplice::constructObjectRTVal("InlineCamera");
-
-          MDagPath cameraDag;
-          view.getCamera(cameraDag);
-          MFnCamera camera(cameraDag);
-
-          bool isOrthographic = camera.isOrtho();
-          FabricCore::RTVal param = FabricSplice::constructBooleanRTVal(isOrthographic);
-          inlineCamera.callMethod("", "setOrthographic", 1, &param);
-
-          if(isOrthographic){
-            double windowAspect = width/height;
-            double left = 0.0;
-            double right = 0.0;
-            double bottom = 0.0;
-            double top = 0.0;
-            bool  applyOverscan = 0.0;
-            bool  applySqueeze = 0.0;
-            bool  applyPanZoom = 0.0;
-            camera.getViewingFrustum ( windowAspect, left, right, bottom, top, applyOverscan, applySqueeze, applyPanZoom );
-            param = FabricSplice::constructFloat64RTVal(top-bottom);
-            inlineCamera.callMethod("", "setOrthographicFrustumHeight", 1, &param);
-          }
-          else{
-            double fovX, fovY;
-            camera.getPortFieldOfView(view.portWidth(), view.portHeight(), fovX, fovY);    
-            param = FabricSplice::constructFloat64RTVal(fovY);
-            inlineCamera.callMethod("", "setFovY", 1, &param);
-          }
-
-          param = FabricSplice::constructFloat64RTVal(camera.nearClippingPlane());
-          inlineCamera.callMethod("", "setNearDistance", 1, &param);
-          param = FabricSplice::constructFloat64RTVal(camera.farClippingPlane());
-          inlineCamera.callMethod("", "setFarDistance", 1, &param);
-
-          MMatrix mayaCameraMatrix = cameraDag.inclusiveMatrix();
-
-          FabricCore::RTVal cameraMat = FabricSplice::constructRTVal("Mat44");
-          FabricCore::RTVal cameraMatData = cameraMat.callMethod("Data", "data", 0, 0);
-          float * cameraMatFloats = (float*)cameraMatData.getData();
-          if(cameraMat) {
-            cameraMatFloats[0] = (float)mayaCameraMatrix[0][0];
-            cameraMatFloats[1] = (float)mayaCameraMatrix[1][0];
-            cameraMatFloats[2] = (float)mayaCameraMatrix[2][0];
-            cameraMatFloats[3] = (float)mayaCameraMatrix[3][0];
-            cameraMatFloats[4] = (float)mayaCameraMatrix[0][1];
-            cameraMatFloats[5] = (float)mayaCameraMatrix[1][1];
-            cameraMatFloats[6] = (float)mayaCameraMatrix[2][1];
-            cameraMatFloats[7] = (float)mayaCameraMatrix[3][1];
-            cameraMatFloats[8] = (float)mayaCameraMatrix[0][2];
-            cameraMatFloats[9] = (float)mayaCameraMatrix[1][2];
-            cameraMatFloats[10] = (float)mayaCameraMatrix[2][2];
-            cameraMatFloats[11] = (float)mayaCameraMatrix[3][2];
-            cameraMatFloats[12] = (float)mayaCameraMatrix[0][3];
-            cameraMatFloats[13] = (float)mayaCameraMatrix[1][3];
-            cameraMatFloats[14] = (float)mayaCameraMatrix[2][3];
-            cameraMatFloats[15] = (float)mayaCameraMatrix[3][3];
-
-            inlineCamera.callMethod("", "setFromMat44", 1, &cameraMat);
-          }
-
-          inlineViewport.callMethod("", "setCamera", 1, &inlineCamera);
-        }
-      }
+      updateViewport(view);
 
       //////////////////////////
       // Setup the Host
@@ -430,7 +536,7 @@ bool FabricSpliceToolContext::onEvent(QEvent *event)
       // Configure the event...
       std::vector<FabricCore::RTVal> args(4);
       args[0] = host;
-      args[1] = inlineViewport;
+      args[1] = mInlineViewport;
       args[2] = FabricSplice::constructUInt32RTVal(eventType);
       args[3] = FabricSplice::constructUInt32RTVal(inputEvent->modifiers());
       klevent.callMethod("", "init", 4, &args[0]);
@@ -445,11 +551,22 @@ bool FabricSpliceToolContext::onEvent(QEvent *event)
 
       // The manipulation system has requested that a node is dirtified.
       // here we use the maya command to dirtify the specified dg node.
+      // Canvas nodes are dirtied through their evalID plug,
+      // everything else still goes through the maya command.
       MString dirtifyDCCNode(host.maybeGetMember("dirtifyNode").getStringCString());
       if(dirtifyDCCNode.length() > 0){
-        MGlobal::executeCommand(MString("dgdirty \"") + dirtifyDCCNode + MString("\""));
+        FabricDFGBaseInterface * dirtifyInterf = FabricDFGBaseInterface::getInstanceByName(dirtifyDCCNode.asChar());
+        if(dirtifyInterf)
+          dirtifyInterf->incrementEvalID();
+        else
+          MGlobal::executeCommand(MString("dgdirty \"") + dirtifyDCCNode + MString("\""));
       }
 
+      // attribute changes requested by the manipulation system
+      // are collected here and applied in one go further down.
+      // owned here until it is handed to the manipulation command.
+      std::auto_ptr<MDGModifier> dgModifier;
+
       // The manipulation system has requested that a custom command be invoked.
       // Invoke the custom command passing the speficied args.
       MString customCommand(host.maybeGetMember("customCommand").getStringCString());
@@ -540,14 +657,16 @@ bool FabricSpliceToolContext::onEvent(QEvent *event)
                   }
                   else if(portResolvedType == "Vec3")
                   {
-                    bool displayEnabled = true;
-                    MString x,y,z;
-                    x.set(value.maybeGetMember("x").getFloat32());
-                    y.set(value.maybeGetMember("y").getFloat32());
-                    z.set(value.maybeGetMember("z").getFloat32());
-                    MGlobal::executeCommand(MString("setAttr ") + attribute + "X " + x + ";", displayEnabled);
-                    MGlobal::executeCommand(MString("setAttr ") + attribute + "Y " + y + ";", displayEnabled);
-                    MGlobal::executeCommand(MString("setAttr ") + attribute + "Z " + z + ";", displayEnabled);
+                    MFnDependencyNode thisNode(dfgInterf->getThisMObject());
+                    MPlug plug = thisNode.findPlug(parts[1]);
+                    if(!plug.isNull() && plug.numChildren() == 3)
+                    {
+                      if(!dgModifier.get())
+                        dgModifier.reset(new MDGModifier());
+                      dgModifier->newPlugValueDouble(plug.child(0), value.maybeGetMember("x").getFloat32());
+                      dgModifier->newPlugValueDouble(plug.child(1), value.maybeGetMember("y").getFloat32());
+                      dgModifier->newPlugValueDouble(plug.child(2), value.maybeGetMember("z").getFloat32());
+                    }
                   }
                   else if(portResolvedType == "Euler")
                   {
@@ -573,15 +692,29 @@ bool FabricSpliceToolContext::onEvent(QEvent *event)
         }
       }
 
+      if(dgModifier.get())
+        dgModifier->doIt();
+
       if(host.maybeGetMember("redrawRequested").getBoolean())
-        view.refresh(true, true);
+        FabricMayaRefreshScheduler::requestRefresh(view);
 
-      if(host.callMethod("Boolean", "undoRedoCommandsAdded", 0, 0).getBoolean()){
+      bool undoRedoCommandsAdded = host.callMethod("Boolean", "undoRedoCommandsAdded", 0, 0).getBoolean();
+      if(undoRedoCommandsAdded || dgModifier.get()){
         // Cache the rtvals in a static variable that the command will then stor in the undo stack.
-        FabricSpliceManipulationCmd::s_rtval_commands = host.callMethod("UndoRedoCommand[]", "getUndoRedoCommands", 0, 0);
+        if(undoRedoCommandsAdded)
+          FabricSpliceManipulationCmd::s_rtval_commands = host.callMethod("UndoRedoCommand[]", "getUndoRedoCommands", 0, 0);
+        FabricSpliceManipulationCmd::s_dgModifier = dgModifier.release();
 
         bool displayEnabled = true;
         MGlobal::executeCommand(MString("fabricSpliceManipulation"), displayEnabled);
+
+        // the command takes the modifier when it is constructed,
+        // it is still here if the command couldn't be created
+        if(FabricSpliceManipulationCmd::s_dgModifier)
+        {
+          delete(FabricSpliceManipulationCmd::s_dgModifier);
+          FabricSpliceManipulationCmd::s_dgModifier = NULL;
+        }
       }
 
       klevent.invalidate();
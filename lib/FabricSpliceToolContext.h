@@ -6,16 +6,20 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QEvent>
+#include <QtCore/QPoint>
 
 #include "Foundation.h"
 #include <FabricSplice.h>
 #include "FabricSpliceBaseInterface.h"
+#include <maya/M3dView.h>
+#include <maya/MDGModifier.h>
 
 class FabricSpliceManipulationCmd : public MPxToolCommand
 {
 
 private:
   FabricCore::RTVal m_rtval_commands;
+  MDGModifier * m_dgModifier;
   
 public:
   FabricSpliceManipulationCmd(); 
@@ -30,6 +34,8 @@ public:
 
   // We set the static commands pointer, and then construct the command. 
   static FabricCore::RTVal s_rtval_commands;
+  // attribute changes already applied by the tool, the command takes ownership
+  static MDGModifier * s_dgModifier;
 };
 
 
@@ -60,10 +66,37 @@ public:
   virtual MStatus doRelease(MEvent &event);
   virtual MStatus doEnterRegion(MEvent &event);
 
-  bool onEvent(QEvent *event);
+  bool onEvent(QObject *object, QEvent *event);
 
 private:
+  bool dispatchEvent(QEvent *event);
+  void flushPendingMouseMove();
+  void updateViewport(M3dView &view);
+  void resetViewport();
+
   FabricCore::RTVal mEventDispatcher;
+
+  // mouse moves are coalesced, only the latest one
+  // is dispatched once the event loop comes around
+  bool mMouseMovePending;
+  bool mLastMouseMoveAccepted;
+  QPoint mPendingMovePos;
+  Qt::MouseButton mPendingMoveButton;
+  Qt::MouseButtons mPendingMoveButtons;
+  Qt::KeyboardModifiers mPendingMoveModifiers;
+
+  // the viewport and camera are kept alive between events
+  // and only updated when the maya camera changes
+  FabricCore::RTVal mDrawContext;
+  FabricCore::RTVal mInlineViewport;
+  FabricCore::RTVal mInlineCamera;
+  double mPortWidth;
+  double mPortHeight;
+  MMatrix mCameraMatrix;
+  bool mCameraIsOrtho;
+  double mCameraFrustum;
+  double mCameraNear;
+  double mCameraFar;
 };
 
 class FabricSpliceToolContextCmd : public MPxContextCommand
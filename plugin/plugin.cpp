@@ -11,12 +11,14 @@
 #include <maya/MFnPlugin.h>
 #include <maya/MSceneMessage.h>
 #include <maya/MDGMessage.h>
+#include <maya/MNodeMessage.h>
 #include <maya/MAnimMessage.h>
 #include <maya/MUiMessage.h>
 #include <maya/MEventMessage.h>
 #include <maya/MQtUtil.h>
 #include <maya/MCommandResult.h>
 #include <maya/MFileIO.h>
+#include <maya/MTimer.h>
 
 #include <FabricSplice.h>
 #include "FabricSpliceMayaNode.h"
@@ -34,6 +36,12 @@
 #include "FabricDFGCommands.h"
 #include "FabricSpliceHelpers.h"
 #include "FabricUpgradeAttrCommand.h"
+#include "FabricCanvasStatsCommand.h"
+#include "FabricMayaLogSink.h"
+#include "FabricMayaRefreshScheduler.h"
+#include "FabricDFGMemoryBudget.h"
+#include "FabricDFGRecorder.h"
+#include "FabricCanvasRecordCommand.h"
 
 #ifdef _MSC_VER
   #define MAYA_EXPORT extern "C" __declspec(dllexport) MStatus _cdecl
@@ -71,10 +79,20 @@ MCallbackId gOnNodeAddedCallbackId;
 MCallbackId gOnNodeRemovedCallbackId;
 MCallbackId gOnNodeAddedDFGCallbackId;
 MCallbackId gOnNodeRemovedDFGCallbackId;
+MCallbackId gOnNodeRenamedDFGCallbackId;
 MCallbackId gOnAnimCurveEditedCallbackId;
 MCallbackId gOnBeforeSceneOpenCallbackId;
 MCallbackId gOnModelPanelSetFocusCallbackId;
 
+// in headless mode (batch / mayapy, or FABRIC_MAYA_HEADLESS=1) only the
+// nodes, data types and scripting commands are registered, none of the
+// widgets, menus, tool context or viewport callbacks.
+static bool gHeadless = false;
+bool isHeadless()
+{
+  return gHeadless;
+}
+
 void resetRenderCallbacks() {
   for(unsigned int i=0;i<gRenderCallbackCount;i++)
     gRenderCallbacksSet[i] = false;
@@ -94,15 +112,22 @@ void onSceneSave(void *userData){
     node->storePersistenceData(mayaGetLastLoadedScene(), &status);
   }
 
+  // make sure the attributes are in sync before Maya writes them
+  FabricDFGBaseInterface::flushAllPendingNotifications();
   FabricDFGBaseInterface::allStorePersistenceData(mayaGetLastLoadedScene(), &status);
 }
 
 void onSceneNew(void *userData){
-  FabricSpliceEditorWidget::postClearAll();
-  FabricSpliceRenderCallback::sDrawContext.invalidate(); 
+  FabricDFGBaseInterface::resetBatch();
+
+  if(!isHeadless())
+  {
+    FabricSpliceEditorWidget::postClearAll();
+    FabricSpliceRenderCallback::sDrawContext.invalidate(); 
 
-  MString cmd = "source \"FabricDFGUI.mel\"; deleteDFGWidget();";
-  MGlobal::executeCommandOnIdle(cmd, false);
+    MString cmd = "source \"FabricDFGUI.mel\"; deleteDFGWidget();";
+    MGlobal::executeCommandOnIdle(cmd, false);
+  }
   FabricDFGWidget::Destroy();
  
   char const *no_client_persistence = ::getenv( "FABRIC_DISABLE_CLIENT_PERSISTENCE" );
@@ -128,8 +153,11 @@ void onSceneNew(void *userData){
 }
 
 void onSceneLoad(void *userData){
-  FabricSpliceEditorWidget::postClearAll();
-  FabricSpliceRenderCallback::sDrawContext.invalidate(); 
+  if(!isHeadless())
+  {
+    FabricSpliceEditorWidget::postClearAll();
+    FabricSpliceRenderCallback::sDrawContext.invalidate(); 
+  }
 
   if(getenv("FABRIC_SPLICE_PROFILING") != NULL)
     FabricSplice::Logging::enableTimers();
@@ -147,7 +175,8 @@ void onSceneLoad(void *userData){
     if( status != MS::kSuccess)
       return;
   }
-  FabricSpliceEditorWidget::postClearAll();
+  if(!isHeadless())
+    FabricSpliceEditorWidget::postClearAll();
 
   FabricDFGBaseInterface::allRestoreFromPersistenceData(mayaGetLastLoadedScene(), &status);
 
@@ -350,7 +379,7 @@ void onModelPanelSetFocus(void * client)
     gRenderCallbacksSet[31] = status == MStatus::kSuccess;
   }
 
-  MGlobal::executeCommandOnIdle("refresh;", false);
+  FabricMayaRefreshScheduler::requestRefresh();
 }
 
 #define MAYA_REGISTER_DFGUICMD( plugin, Name ) \
@@ -370,6 +399,15 @@ __attribute__ ((visibility("default")))
 #endif
 MAYA_EXPORT initializePlugin(MObject obj)
 {
+  MTimer startupTimer;
+  startupTimer.beginTimer();
+
+  char const *headless = ::getenv( "FABRIC_MAYA_HEADLESS" );
+  if (!!headless && !!headless[0])
+    gHeadless = headless[0] != '0';
+  else
+    gHeadless = MGlobal::mayaState() != MGlobal::kInteractive;
+
   // [FE-6287]
   char const *disable_evalContext = ::getenv( "FABRIC_MAYA_DISABLE_EVALCONTEXT" );
   FabricDFGBaseInterface::s_use_evalContext = !(!!disable_evalContext && !!disable_evalContext[0]);
@@ -379,12 +417,20 @@ MAYA_EXPORT initializePlugin(MObject obj)
   MFnPlugin plugin(obj, "FabricMaya", FabricSplice::GetFabricVersionStr(), "Any");
   MStatus status;
 
-  status = plugin.registerContextCommand("FabricSpliceToolContext", FabricSpliceToolContextCmd::creator, "FabricSpliceToolCommand", FabricSpliceToolCmd::creator  );
-
-  loadMenu();
+  FabricMayaLogSink::initialize();
+  FabricMayaRefreshScheduler::initialize();
+  FabricDFGMemoryBudget::initialize();
+  FabricDFGRecorder::initialize();
 
   resetRenderCallbacks();
 
+  if(!isHeadless())
+  {
+    status = plugin.registerContextCommand("FabricSpliceToolContext", FabricSpliceToolContextCmd::creator, "FabricSpliceToolCommand", FabricSpliceToolCmd::creator  );
+
+    loadMenu();
+  }
+
   gOnSceneSaveCallbackId = MSceneMessage::addCallback(MSceneMessage::kBeforeSave, onSceneSave);
   gOnSceneLoadCallbackId = MSceneMessage::addCallback(MSceneMessage::kAfterOpen, onSceneLoad);
   gOnBeforeSceneOpenCallbackId = MSceneMessage::addCallback(MSceneMessage::kBeforeOpen, onSceneNew);
@@ -395,39 +441,50 @@ MAYA_EXPORT initializePlugin(MObject obj)
   gOnSceneCreateReferenceCallbackId = MSceneMessage::addCallback(MSceneMessage::kAfterCreateReference, onSceneLoad);
   gOnSceneImportReferenceCallbackId = MSceneMessage::addCallback(MSceneMessage::kAfterImportReference, onSceneLoad);
   gOnSceneLoadReferenceCallbackId = MSceneMessage::addCallback(MSceneMessage::kAfterLoadReference, onSceneLoad);
-  gRenderCallbacks[0] = MUiMessage::add3dViewPostRenderMsgCallback("modelPanel0", FabricSpliceRenderCallback::draw);
-  gRenderCallbacksSet[0] = true;
-  gRenderCallbacks[1] = MUiMessage::add3dViewPostRenderMsgCallback("modelPanel1", FabricSpliceRenderCallback::draw);
-  gRenderCallbacksSet[1] = true;
-  gRenderCallbacks[2] = MUiMessage::add3dViewPostRenderMsgCallback("modelPanel2", FabricSpliceRenderCallback::draw);
-  gRenderCallbacksSet[2] = true;
-  gRenderCallbacks[3] = MUiMessage::add3dViewPostRenderMsgCallback("modelPanel3", FabricSpliceRenderCallback::draw);
-  gRenderCallbacksSet[3] = true;
-  gRenderCallbacks[4] = MUiMessage::add3dViewPostRenderMsgCallback("modelPanel4", FabricSpliceRenderCallback::draw);
-  gRenderCallbacksSet[4] = true;
+  if(!isHeadless())
+  {
+    gRenderCallbacks[0] = MUiMessage::add3dViewPostRenderMsgCallback("modelPanel0", FabricSpliceRenderCallback::draw);
+    gRenderCallbacksSet[0] = true;
+    gRenderCallbacks[1] = MUiMessage::add3dViewPostRenderMsgCallback("modelPanel1", FabricSpliceRenderCallback::draw);
+    gRenderCallbacksSet[1] = true;
+    gRenderCallbacks[2] = MUiMessage::add3dViewPostRenderMsgCallback("modelPanel2", FabricSpliceRenderCallback::draw);
+    gRenderCallbacksSet[2] = true;
+    gRenderCallbacks[3] = MUiMessage::add3dViewPostRenderMsgCallback("modelPanel3", FabricSpliceRenderCallback::draw);
+    gRenderCallbacksSet[3] = true;
+    gRenderCallbacks[4] = MUiMessage::add3dViewPostRenderMsgCallback("modelPanel4", FabricSpliceRenderCallback::draw);
+    gRenderCallbacksSet[4] = true;
+  }
   gOnNodeAddedCallbackId = MDGMessage::addNodeAddedCallback(FabricSpliceBaseInterface::onNodeAdded);
   gOnNodeRemovedCallbackId = MDGMessage::addNodeRemovedCallback(FabricSpliceBaseInterface::onNodeRemoved);
   gOnNodeAddedDFGCallbackId = MDGMessage::addNodeAddedCallback(FabricDFGBaseInterface::onNodeAdded);
   gOnNodeRemovedDFGCallbackId = MDGMessage::addNodeRemovedCallback(FabricDFGBaseInterface::onNodeRemoved);
+  gOnNodeRenamedDFGCallbackId = MNodeMessage::addNameChangedCallback(MObject::kNullObj, FabricDFGBaseInterface::onNodeRenamed);
   gOnAnimCurveEditedCallbackId = MAnimMessage::addAnimCurveEditedCallback(FabricDFGBaseInterface::onAnimCurveEdited);
-  gOnModelPanelSetFocusCallbackId = MEventMessage::addEventCallback("ModelPanelSetFocus", &onModelPanelSetFocus);
+  if(!isHeadless())
+    gOnModelPanelSetFocusCallbackId = MEventMessage::addEventCallback("ModelPanelSetFocus", &onModelPanelSetFocus);
 
   plugin.registerData(FabricSpliceMayaData::typeName, FabricSpliceMayaData::id, FabricSpliceMayaData::creator);
 
 
   plugin.registerCommand("fabricSplice", FabricSpliceCommand::creator);//, FabricSpliceEditorCmd::newSyntax);
-  plugin.registerCommand("fabricSpliceEditor", FabricSpliceEditorCmd::creator, FabricSpliceEditorCmd::newSyntax);
-  plugin.registerCommand("fabricSpliceManipulation", FabricSpliceManipulationCmd::creator);
+  if(!isHeadless())
+  {
+    plugin.registerCommand("fabricSpliceEditor", FabricSpliceEditorCmd::creator, FabricSpliceEditorCmd::newSyntax);
+    plugin.registerCommand("fabricSpliceManipulation", FabricSpliceManipulationCmd::creator);
+  }
   plugin.registerCommand("proceedToNextScene", ProceedToNextSceneCommand::creator);//, FabricSpliceEditorCmd::newSyntax);
 
   plugin.registerNode("spliceMayaNode", FabricSpliceMayaNode::id, FabricSpliceMayaNode::creator, FabricSpliceMayaNode::initialize);
   plugin.registerNode("spliceMayaDeformer", FabricSpliceMayaDeformer::id, FabricSpliceMayaDeformer::creator, FabricSpliceMayaDeformer::initialize, MPxNode::kDeformerNode);
 
 
-  MQtUtil::registerUIType("FabricSpliceEditor", FabricSpliceEditorWidget::creator, "fabricSpliceEditor");
+  if(!isHeadless())
+  {
+    MQtUtil::registerUIType("FabricSpliceEditor", FabricSpliceEditorWidget::creator, "fabricSpliceEditor");
 
-  plugin.registerCommand("fabricDFG", FabricDFGWidgetCommand::creator, FabricDFGWidgetCommand::newSyntax);
-  MQtUtil::registerUIType("FabricDFGWidget", FabricDFGWidget::creator, "fabricDFGWidget");
+    plugin.registerCommand("fabricDFG", FabricDFGWidgetCommand::creator, FabricDFGWidgetCommand::newSyntax);
+    MQtUtil::registerUIType("FabricDFGWidget", FabricDFGWidget::creator, "fabricDFGWidget");
+  }
 
   // obsolete node
   plugin.registerNode("dfgMayaNode", 0x0011AE46, FabricDFGMayaNode::creator, FabricDFGMayaNode::initialize);
@@ -492,7 +549,20 @@ MAYA_EXPORT initializePlugin(MObject obj)
     FabricCanvasSetExecuteSharedCommand::newSyntax
     );
 
+  plugin.registerCommand(
+    "FabricCanvasBeginBatch",
+    FabricCanvasBeginBatchCommand::creator,
+    FabricCanvasBeginBatchCommand::newSyntax
+    );
+  plugin.registerCommand(
+    "FabricCanvasEndBatch",
+    FabricCanvasEndBatchCommand::creator,
+    FabricCanvasEndBatchCommand::newSyntax
+    );
+
   plugin.registerCommand("fabricUpgradeAttrs", FabricUpgradeAttrCommand::creator, FabricUpgradeAttrCommand::newSyntax);
+  plugin.registerCommand("FabricCanvasStats", FabricCanvasStatsCommand::creator, FabricCanvasStatsCommand::newSyntax);
+  plugin.registerCommand("FabricCanvasRecord", FabricCanvasRecordCommand::creator, FabricCanvasRecordCommand::newSyntax);
 
   MString pluginPath = plugin.loadPath();
   MString lastFolder("plug-ins");
@@ -507,15 +577,24 @@ MAYA_EXPORT initializePlugin(MObject obj)
   FabricSplice::Logging::setCompilerErrorFunc(mayaCompilerErrorFunc);
   // FabricSplice::SceneManagement::setManipulationFunc(FabricSpliceBaseInterface::manipulationCallback);
 
-  MGlobal::executePythonCommandOnIdle("import AEspliceMayaNodeTemplate", true);
-  MGlobal::executePythonCommandOnIdle("import AEdfgMayaNodeTemplate", true);
-  MGlobal::executePythonCommandOnIdle("import AEcanvasNodeTemplate", true);
+  if(!isHeadless())
+  {
+    MGlobal::executePythonCommandOnIdle("import AEspliceMayaNodeTemplate", true);
+    MGlobal::executePythonCommandOnIdle("import AEdfgMayaNodeTemplate", true);
+    MGlobal::executePythonCommandOnIdle("import AEcanvasNodeTemplate", true);
+  }
 
   if (MGlobal::mayaState() == MGlobal::kInteractive)
     FabricSplice::SetLicenseType(FabricCore::ClientLicenseType_Interactive);
   else
     FabricSplice::SetLicenseType(FabricCore::ClientLicenseType_Compute);
 
+  // the Core client itself is only constructed once the first node needs it
+  startupTimer.endTimer();
+  MString startupTime;
+  startupTime.set(startupTimer.elapsedTime() * 1000.0, 1);
+  MGlobal::displayInfo(MString("[Fabric for Maya]: plugin initialized in ") + startupTime + " ms" + (isHeadless() ? " (headless mode)." : "."));
+
   return status;
 }
 
@@ -527,7 +606,8 @@ MAYA_EXPORT uninitializePlugin(MObject obj)
   MFnPlugin plugin(obj);
   MStatus status;
 
-  unloadMenu();
+  if(!isHeadless())
+    unloadMenu();
 
   plugin.deregisterCommand("fabricSplice");
   plugin.deregisterCommand("fabricUpgradeAttrs");
@@ -545,26 +625,37 @@ MAYA_EXPORT uninitializePlugin(MObject obj)
   MSceneMessage::removeCallback(gOnSceneCreateReferenceCallbackId);
   MSceneMessage::removeCallback(gOnSceneImportReferenceCallbackId);
   MSceneMessage::removeCallback(gOnSceneLoadReferenceCallbackId);
-  MEventMessage::removeCallback(gOnModelPanelSetFocusCallbackId);
+  if(!isHeadless())
+    MEventMessage::removeCallback(gOnModelPanelSetFocusCallbackId);
+  FabricDFGBaseInterface::flushAllPendingNotifications();
 
   for(unsigned int i=0;i<gRenderCallbackCount;i++)
-    MUiMessage::removeCallback(gRenderCallbacks[i]);
+  {
+    if(gRenderCallbacksSet[i])
+      MUiMessage::removeCallback(gRenderCallbacks[i]);
+  }
 
   MDGMessage::removeCallback(gOnNodeAddedCallbackId);
   MDGMessage::removeCallback(gOnNodeRemovedCallbackId);
 
   MDGMessage::removeCallback(gOnNodeAddedDFGCallbackId);
   MDGMessage::removeCallback(gOnNodeRemovedDFGCallbackId);
+  MNodeMessage::removeCallback(gOnNodeRenamedDFGCallbackId);
   MDGMessage::removeCallback(gOnAnimCurveEditedCallbackId);
 
   plugin.deregisterData(FabricSpliceMayaData::id);
 
-  MQtUtil::deregisterUIType("FabricSpliceEditor");
+  if(!isHeadless())
+  {
+    plugin.deregisterCommand("fabricSpliceEditor");
+    plugin.deregisterCommand("fabricSpliceManipulation");
+    MQtUtil::deregisterUIType("FabricSpliceEditor");
 
-  plugin.deregisterContextCommand("FabricSpliceToolContext", "FabricSpliceToolCommand");
+    plugin.deregisterContextCommand("FabricSpliceToolContext", "FabricSpliceToolCommand");
 
-  plugin.deregisterCommand("fabricDFG");
-  MQtUtil::deregisterUIType("FabricDFGWidget");
+    plugin.deregisterCommand("fabricDFG");
+    MQtUtil::deregisterUIType("FabricDFGWidget");
+  }
   plugin.deregisterNode(FabricDFGMayaNode::id);
   plugin.deregisterNode(FabricDFGMayaDeformer::id);
 
@@ -604,6 +695,15 @@ MAYA_EXPORT uninitializePlugin(MObject obj)
   plugin.deregisterCommand( "dfgImportJSON" );
   plugin.deregisterCommand( "dfgReloadJSON" );
   plugin.deregisterCommand( "dfgExportJSON" );
+  plugin.deregisterCommand( "FabricCanvasBeginBatch" );
+  plugin.deregisterCommand( "FabricCanvasEndBatch" );
+  plugin.deregisterCommand( "FabricCanvasStats" );
+  plugin.deregisterCommand( "FabricCanvasRecord" );
+
+  FabricDFGRecorder::shutdown();
+  FabricDFGMemoryBudget::shutdown();
+  FabricMayaRefreshScheduler::shutdown();
+  FabricMayaLogSink::shutdown();
 
   // [pzion 20141201] RM#3318: it seems that sending KL report statements
   // at this point, which might result from destructors called by
@@ -6,5 +6,6 @@
 void loadMenu();
 void unloadMenu();
 bool isDestroyingScene();
+bool isHeadless();
 
 #endif
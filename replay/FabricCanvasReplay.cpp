@@ -0,0 +1,281 @@
+//
+// Copyright (c) 2010-2016, Fabric Software Inc. All rights reserved.
+//
+
+// Replays a recording of Canvas node evaluations (see FabricDFGRecorder
+// and the FabricCanvasRecord command) through Fabric Core alone and
+// reports the execution time of every frame.
+// Usage: FabricCanvasReplay <recording> [passes]
+// With several passes the frames of the last pass are reported, the
+// earlier ones warm up the bindings.
+
+#include "FabricDFGRecording.h"
+
+#include <FabricCore.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <set>
+#include <fstream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+static double getSeconds()
+{
+#if defined(_WIN32)
+  LARGE_INTEGER frequency, counter;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec * 1.0e-6;
+#endif
+}
+
+static void reportCallback(
+  void *reportUserdata,
+  FEC_ReportSource source,
+  FEC_ReportLevel level,
+  char const *data,
+  uint32_t size
+  )
+{
+  if(level == FEC_ReportLevel_Error)
+    fprintf(stderr, "%.*s\n", (int)size, data);
+  else
+    printf("%.*s\n", (int)size, data);
+}
+
+struct ReplayNode
+{
+  std::string name;
+  FabricCore::DFGBinding binding;
+};
+
+struct Frame
+{
+  double time;
+  unsigned int evaluations;
+  double seconds;
+};
+
+class Replay
+{
+public:
+
+  Replay(FabricCore::Client & client)
+  : m_client(client)
+  , m_bindingSeconds(0.0)
+  {
+    try
+    {
+      m_evalContext = FabricCore::RTVal::Create(m_client, "EvalContext", 0, 0);
+      m_evalContext = m_evalContext.callMethod("EvalContext", "getInstance", 0, 0);
+      m_evalContext.setMember("host", FabricCore::RTVal::ConstructString(m_client, "Maya"));
+    }
+    catch(FabricCore::Exception e)
+    {
+      fprintf(stderr, "EvalContext: %s\n", e.getDesc_cstr());
+    }
+  }
+
+  // replays the whole stream once, returns false if it isn't a recording
+  bool run(const char * filePath, std::vector<Frame> & frames)
+  {
+    std::ifstream stream(filePath, std::ios::in | std::ios::binary);
+    if(!FabricDFGRecording::readHeader(stream))
+    {
+      fprintf(stderr, "'%s' is not a recording of this version.\n", filePath);
+      return false;
+    }
+
+    frames.clear();
+    FabricDFGRecording::Record record;
+    for(;;)
+    {
+      std::streamoff offset = stream.tellg();
+      if(!FabricDFGRecording::readRecord(stream, record))
+        break;
+
+      if(record.kind == FabricDFGRecording::RecordKind_Binding)
+        setupBinding(offset, record);
+      else
+        evaluate(record, frames);
+    }
+    return true;
+  }
+
+  double getBindingSeconds() const
+  {
+    return m_bindingSeconds;
+  }
+
+  size_t getNumBindings() const
+  {
+    return m_bindings.size();
+  }
+
+private:
+
+  void setupBinding(std::streamoff offset, const FabricDFGRecording::Record & record)
+  {
+    // the bindings are only created on the first pass
+    std::map<std::streamoff, FabricCore::DFGBinding>::iterator it = m_bindings.find(offset);
+    if(it == m_bindings.end())
+    {
+      double start = getSeconds();
+      FabricCore::DFGBinding binding;
+      try
+      {
+        binding = m_client.getDFGHost().createBindingFromJSON(record.json.c_str());
+      }
+      catch(FabricCore::Exception e)
+      {
+        fprintf(stderr, "%s: %s\n", record.nodeName.c_str(), e.getDesc_cstr());
+      }
+      m_bindingSeconds += getSeconds() - start;
+      it = m_bindings.insert(std::make_pair(offset, binding)).first;
+    }
+
+    ReplayNode & node = m_nodes[record.nodeId];
+    node.name = record.nodeName;
+    node.binding = it->second;
+  }
+
+  void evaluate(const FabricDFGRecording::Record & record, std::vector<Frame> & frames)
+  {
+    std::map<uint32_t, ReplayNode>::iterator it = m_nodes.find(record.nodeId);
+    if(it == m_nodes.end() || !it->second.binding.isValid())
+      return;
+    ReplayNode & node = it->second;
+
+    FabricCore::DFGExec exec = node.binding.getExec();
+    for(size_t i=0;i<record.args.size();i++)
+    {
+      const FabricDFGRecording::Arg & arg = record.args[i];
+      if(!exec.haveExecPort(arg.name.c_str()))
+        continue;
+      try
+      {
+        node.binding.setArgValue(arg.name.c_str(), FabricDFGRecording::decodeArg(m_client, arg), false);
+      }
+      catch(FabricCore::Exception e)
+      {
+        // report every argument only once, the previous value is kept
+        std::string key = node.name + "." + arg.name;
+        if(m_failedArgs.insert(key).second)
+          fprintf(stderr, "%s (%s): %s\n", key.c_str(), arg.type.c_str(), e.getDesc_cstr());
+      }
+    }
+
+    if(m_evalContext.isValid())
+    {
+      try
+      {
+        m_evalContext.setMember("graph", FabricCore::RTVal::ConstructString(m_client, node.name.c_str()));
+        m_evalContext.setMember("time", FabricCore::RTVal::ConstructFloat32(m_client, (float)record.time));
+      }
+      catch(FabricCore::Exception e)
+      {
+        fprintf(stderr, "EvalContext: %s\n", e.getDesc_cstr());
+      }
+    }
+
+    double start = getSeconds();
+    try
+    {
+      node.binding.execute();
+    }
+    catch(FabricCore::Exception e)
+    {
+      fprintf(stderr, "%s: %s\n", node.name.c_str(), e.getDesc_cstr());
+    }
+    double seconds = getSeconds() - start;
+
+    // consecutive evaluations at the same time make up a frame
+    if(frames.size() == 0 || frames.back().time != record.time)
+    {
+      Frame frame;
+      frame.time = record.time;
+      frame.evaluations = 0;
+      frame.seconds = 0.0;
+      frames.push_back(frame);
+    }
+    frames.back().evaluations++;
+    frames.back().seconds += seconds;
+  }
+
+  FabricCore::Client & m_client;
+  FabricCore::RTVal m_evalContext;
+  std::map<std::streamoff, FabricCore::DFGBinding> m_bindings;
+  std::map<uint32_t, ReplayNode> m_nodes;
+  std::set<std::string> m_failedArgs;
+  double m_bindingSeconds;
+};
+
+int main(int argc, char ** argv)
+{
+  if(argc < 2)
+  {
+    fprintf(stderr, "Usage: FabricCanvasReplay <recording> [passes]\n");
+    return 1;
+  }
+
+  const char * filePath = argv[1];
+  int passes = 1;
+  if(argc > 2)
+    passes = atoi(argv[2]);
+  if(passes < 1)
+    passes = 1;
+
+  try
+  {
+    FabricCore::Client::CreateOptions options;
+    memset(&options, 0, sizeof(options));
+    options.guarded = 1;
+    options.optimizationType = FabricCore::ClientOptimizationType_Background;
+    FabricCore::Client client(&reportCallback, NULL, &options);
+
+    Replay replay(client);
+    std::vector<Frame> frames;
+    for(int pass=0;pass<passes;pass++)
+    {
+      if(!replay.run(filePath, frames))
+        return 1;
+    }
+
+    printf("frame,time,evaluations,ms\n");
+    double total = 0.0, minimum = 0.0, maximum = 0.0;
+    unsigned int evaluations = 0;
+    for(size_t i=0;i<frames.size();i++)
+    {
+      double ms = frames[i].seconds * 1000.0;
+      printf("%lu,%g,%u,%.3f\n", (unsigned long)i, frames[i].time, frames[i].evaluations, ms);
+      total += ms;
+      evaluations += frames[i].evaluations;
+      if(i == 0 || ms < minimum)
+        minimum = ms;
+      if(i == 0 || ms > maximum)
+        maximum = ms;
+    }
+
+    printf("\nbindings: %lu, created in %.3f ms\n", (unsigned long)replay.getNumBindings(), replay.getBindingSeconds() * 1000.0);
+    printf("frames: %lu, evaluations: %u, passes: %d\n", (unsigned long)frames.size(), evaluations, passes);
+    if(frames.size() > 0)
+      printf("total: %.3f ms, mean: %.3f ms, min: %.3f ms, max: %.3f ms\n", total, total / (double)frames.size(), minimum, maximum);
+  }
+  catch(FabricCore::Exception e)
+  {
+    fprintf(stderr, "%s\n", e.getDesc_cstr());
+    return 1;
+  }
+  return 0;
+}